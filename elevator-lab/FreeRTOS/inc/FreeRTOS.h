@@ -69,6 +69,9 @@
 /* Definitions specific to the port being used. */
 #include "portable.h"
 
+/* List types, used by the static object types at the end of this file. */
+#include "list.h"
+
 
 /* Defines the prototype to which the application task hook function must
 conform. */
@@ -168,6 +171,50 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define configIDLE_SHOULD_YIELD		1
 #endif
 
+#ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
+	#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+#endif
+
+#if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 1 )
+	#ifndef portGET_HIGHEST_PRIORITY
+		#error If configUSE_PORT_OPTIMISED_TASK_SELECTION is set to 1 then portRECORD_READY_PRIORITY, portRESET_READY_PRIORITY and portGET_HIGHEST_PRIORITY must be defined by the port.
+	#endif
+#endif
+
+#ifndef configUSE_TICKLESS_IDLE
+	#define configUSE_TICKLESS_IDLE 0
+#endif
+
+#ifndef configEXPECTED_IDLE_TIME_BEFORE_SLEEP
+	#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP 2
+#endif
+
+#if configEXPECTED_IDLE_TIME_BEFORE_SLEEP < 2
+	#error configEXPECTED_IDLE_TIME_BEFORE_SLEEP must not be less than 2
+#endif
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+	#ifndef portSUPPRESS_TICKS_AND_SLEEP
+		#error If configUSE_TICKLESS_IDLE is set to 1 then portSUPPRESS_TICKS_AND_SLEEP must be defined by the port.
+	#endif
+#endif
+
+#ifndef configUSE_TASK_NOTIFICATIONS
+	#define configUSE_TASK_NOTIFICATIONS 0
+#endif
+
+#ifndef configSUPPORT_STATIC_ALLOCATION
+	#define configSUPPORT_STATIC_ALLOCATION 0
+#endif
+
+#ifndef configSUPPORT_DYNAMIC_ALLOCATION
+	#define configSUPPORT_DYNAMIC_ALLOCATION 1
+#endif
+
+#if ( ( configSUPPORT_STATIC_ALLOCATION == 0 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 0 ) )
+	#error At least one of configSUPPORT_STATIC_ALLOCATION and configSUPPORT_DYNAMIC_ALLOCATION must be set to 1.
+#endif
+
 #if configMAX_TASK_NAME_LEN < 1
 	#undef configMAX_TASK_NAME_LEN
 	#define configMAX_TASK_NAME_LEN 1
@@ -416,5 +463,73 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define vPortFreeAligned( pvBlockToFree ) vPortFree( pvBlockToFree )
 #endif
 
+/*-----------------------------------------------------------
+ * Memory for objects created with the static allocation functions.  These
+ * are defined here rather than in task.h and queue.h as queue.c cannot
+ * include queue.h.
+ *----------------------------------------------------------*/
+
+/*
+ * Memory for the TCB of a task created by xTaskCreateStatic().  The members
+ * mirror those of the TCB in tasks.c, which checks that both have the same
+ * size.  They are not meant to be accessed by the application.
+ */
+typedef struct xSTATIC_TCB
+{
+	void *pvDummy1;
+	#if ( portUSING_MPU_WRAPPERS == 1 )
+		xMPU_SETTINGS xDummy2;
+	#endif
+	xListItem xDummy3[ 2 ];
+	unsigned portBASE_TYPE uxDummy4;
+	void *pvDummy5;
+	signed char ucDummy6[ configMAX_TASK_NAME_LEN ];
+	#if ( portSTACK_GROWTH > 0 )
+		void *pvDummy7;
+	#endif
+	#if ( portCRITICAL_NESTING_IN_TCB == 1 )
+		unsigned portBASE_TYPE uxDummy8;
+	#endif
+	#if ( configUSE_TRACE_FACILITY == 1 )
+		unsigned portBASE_TYPE uxDummy9;
+	#endif
+	#if ( configUSE_MUTEXES == 1 )
+		unsigned portBASE_TYPE uxDummy10;
+	#endif
+	#if ( configUSE_APPLICATION_TASK_TAG == 1 )
+		void *pvDummy11;
+	#endif
+	#if ( configGENERATE_RUN_TIME_STATS == 1 )
+		unsigned long ulDummy12;
+	#endif
+	#if ( INCLUDE_uxTaskGetStackHighWaterMark == 1 )
+		unsigned short usDummy13;
+	#endif
+	#if ( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+		unsigned char ucDummy14;
+	#endif
+	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+		unsigned long ulDummy15;
+		unsigned char ucDummy16;
+	#endif
+} xStaticTaskType;
+
+/*
+ * Memory for the queue, semaphore or mutex created by xQueueCreateStatic()
+ * or xSemaphoreCreateMutexStatic().  The members mirror those of the queue
+ * structure in queue.c, which checks that both have the same size.  They are
+ * not meant to be accessed by the application.
+ */
+typedef struct xSTATIC_QUEUE
+{
+	void *pvDummy1[ 4 ];
+	xList xDummy2[ 2 ];
+	unsigned portBASE_TYPE uxDummy3[ 3 ];
+	signed portBASE_TYPE xDummy4[ 2 ];
+	#if ( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+		unsigned char ucDummy5;
+	#endif
+} xStaticQueueType;
+
 #endif /* INC_FREERTOS_H */
 
@@ -357,6 +357,20 @@ void vPortFree( void *pv ) PRIVILEGED_FUNCTION;
 void vPortInitialiseBlocks( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * State of the heap, as returned by vPortGetHeapStats().  Only provided by
+ * heap implementations that coalesce free blocks (heap_tlsf.c).
+ */
+typedef struct xHEAP_STATS
+{
+	size_t xFreeBytes;						/*< Free bytes, including the block headers. */
+	size_t xLargestFreeBlock;				/*< Largest size that pvPortMalloc() can currently return. */
+	size_t xMinimumEverFreeBytes;			/*< Lowest number of free bytes since the heap was set up. */
+	unsigned portBASE_TYPE uxFragmentation;	/*< Percentage of the free bytes outside the largest free block. */
+} xHeapStatsType;
+
+void vPortGetHeapStats( xHeapStatsType *pxHeapStats ) PRIVILEGED_FUNCTION;
+
 /*
  * Setup the hardware ready for the scheduler to take control.  This generally
  * sets up a tick interrupt and sets timers for the correct tick frequency.
@@ -125,6 +125,18 @@ extern void vPortExitCritical( void );
 
 #define portNOP()
 
+/* Port optimised task selection: the ready priorities are kept in a bitmap,
+and the highest one is found with the CLZ instruction (__clz is an RVDS
+intrinsic).  configMAX_PRIORITIES must not exceed 32. */
+#define portRECORD_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) |= ( 1UL << ( uxPriority ) )
+#define portRESET_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) &= ~( 1UL << ( uxPriority ) )
+#define portGET_HIGHEST_PRIORITY( uxTopPriority, uxReadyPriorities ) uxTopPriority = ( 31 - __clz( ( uxReadyPriorities ) ) )
+
+/* Tickless idle: stop the SysTick and sleep until the next task has to be
+unblocked, or until an interrupt occurs. */
+extern void vPortSuppressTicksAndSleep( portTickType xExpectedIdleTime );
+#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vPortSuppressTicksAndSleep( xExpectedIdleTime )
+
 #ifdef __cplusplus
 }
 #endif
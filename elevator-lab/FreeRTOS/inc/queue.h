@@ -135,6 +135,54 @@ typedef void * xQueueHandle;
  */
 xQueueHandle xQueueCreate( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize );
 
+/**
+ * queue. h
+ * <pre>
+ xQueueHandle xQueueCreateStatic(
+							  unsigned portBASE_TYPE uxQueueLength,
+							  unsigned portBASE_TYPE uxItemSize,
+							  unsigned char *pucQueueStorage,
+							  xStaticQueueType *pxStaticQueue
+						  );
+ * </pre>
+ *
+ * configSUPPORT_STATIC_ALLOCATION must be set to 1 in FreeRTOSConfig.h for
+ * this function to be available.
+ *
+ * Creates a new queue instance, like xQueueCreate(), but in memory supplied
+ * by the caller instead of memory allocated from the heap.  Both buffers must
+ * stay valid for as long as the queue exists; they are usually declared
+ * static.
+ *
+ * @param pucQueueStorage Array of at least uxQueueLength * uxItemSize bytes
+ * that holds the items in the queue.  May be NULL if uxItemSize is 0.
+ *
+ * @param pxStaticQueue Variable that holds the queue structure.
+ *
+ * The other parameters and the return value are those of xQueueCreate().
+ *
+ * Example usage:
+   <pre>
+ #define QUEUE_LENGTH 10
+
+ static unsigned char ucQueueStorage[ QUEUE_LENGTH * sizeof( unsigned long ) ];
+ static xStaticQueueType xQueueBuffer;
+
+ void vATask( void *pvParameters )
+ {
+ xQueueHandle xQueue;
+
+	// Create a queue capable of containing 10 unsigned long values.
+	xQueue = xQueueCreateStatic( QUEUE_LENGTH, sizeof( unsigned long ), ucQueueStorage, &xQueueBuffer );
+
+	// ... Rest of task code.
+ }
+ </pre>
+ * \defgroup xQueueCreateStatic xQueueCreateStatic
+ * \ingroup QueueManagement
+ */
+xQueueHandle xQueueCreateStatic( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char *pucQueueStorage, xStaticQueueType *pxStaticQueue );
+
 /**
  * queue. h
  * <pre>
@@ -1213,10 +1261,12 @@ signed portBASE_TYPE xQueueCRSend( xQueueHandle pxQueue, const void *pvItemToQue
 signed portBASE_TYPE xQueueCRReceive( xQueueHandle pxQueue, void *pvBuffer, portTickType xTicksToWait );
 
 /*
- * For internal use only.  Use xSemaphoreCreateMutex() or
- * xSemaphoreCreateCounting() instead of calling these functions directly.
+ * For internal use only.  Use xSemaphoreCreateMutex(),
+ * xSemaphoreCreateMutexStatic() or xSemaphoreCreateCounting() instead of
+ * calling these functions directly.
  */
 xQueueHandle xQueueCreateMutex( void );
+xQueueHandle xQueueCreateMutexStatic( xStaticQueueType *pxStaticQueue );
 xQueueHandle xQueueCreateCountingSemaphore( unsigned portBASE_TYPE uxCountValue, unsigned portBASE_TYPE uxInitialCount );
 
 /*
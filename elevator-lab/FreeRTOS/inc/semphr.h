@@ -113,6 +113,43 @@ typedef xQueueHandle xSemaphoreHandle;
 														}																							\
 													}
 
+/**
+ * semphr. h
+ * <pre>vSemaphoreCreateBinaryStatic( xSemaphoreHandle xSemaphore, xStaticQueueType *pxSemaphoreBuffer )</pre>
+ *
+ * configSUPPORT_STATIC_ALLOCATION must be set to 1 in FreeRTOSConfig.h for
+ * this macro to be available.
+ *
+ * <i>Macro</i> that creates a binary semaphore like vSemaphoreCreateBinary(),
+ * but in the variable pointed to by pxSemaphoreBuffer instead of memory
+ * allocated from the heap.  The variable must stay valid for as long as the
+ * semaphore exists.
+ *
+ * @param xSemaphore Handle to the created semaphore.  Should be of type xSemaphoreHandle.
+ *
+ * @param pxSemaphoreBuffer Variable that holds the semaphore.
+ *
+ * Example usage:
+ <pre>
+ xSemaphoreHandle xSemaphore;
+ static xStaticQueueType xSemaphoreBuffer;
+
+ void vATask( void * pvParameters )
+ {
+    vSemaphoreCreateBinaryStatic( xSemaphore, &xSemaphoreBuffer );
+ }
+ </pre>
+ * \defgroup vSemaphoreCreateBinaryStatic vSemaphoreCreateBinaryStatic
+ * \ingroup Semaphores
+ */
+#define vSemaphoreCreateBinaryStatic( xSemaphore, pxSemaphoreBuffer )	{																														\
+																			xSemaphore = xQueueCreateStatic( ( unsigned portBASE_TYPE ) 1, semSEMAPHORE_QUEUE_ITEM_LENGTH, NULL, ( pxSemaphoreBuffer ) );	\
+																			if( xSemaphore != NULL )																							\
+																			{																													\
+																				xSemaphoreGive( xSemaphore );																					\
+																			}																													\
+																		}
+
 /**
  * semphr. h
  * <pre>xSemaphoreTake( 
@@ -587,6 +624,36 @@ typedef xQueueHandle xSemaphoreHandle;
  */
 #define xSemaphoreCreateMutex() xQueueCreateMutex()
 
+/**
+ * semphr. h
+ * <pre>xSemaphoreHandle xSemaphoreCreateMutexStatic( xStaticQueueType *pxMutexBuffer )</pre>
+ *
+ * configSUPPORT_STATIC_ALLOCATION must be set to 1 in FreeRTOSConfig.h for
+ * this macro to be available.
+ *
+ * <i>Macro</i> that creates a mutex semaphore like xSemaphoreCreateMutex(),
+ * but in the variable pointed to by pxMutexBuffer instead of memory allocated
+ * from the heap.  The variable must stay valid for as long as the mutex
+ * exists.
+ *
+ * @return xSemaphore Handle to the created mutex semaphore, or NULL if
+ *		pxMutexBuffer is NULL.
+ *
+ * Example usage:
+ <pre>
+ xSemaphoreHandle xSemaphore;
+ static xStaticQueueType xMutexBuffer;
+
+ void vATask( void * pvParameters )
+ {
+    xSemaphore = xSemaphoreCreateMutexStatic( &xMutexBuffer );
+ }
+ </pre>
+ * \defgroup xSemaphoreCreateMutexStatic xSemaphoreCreateMutexStatic
+ * \ingroup Semaphores
+ */
+#define xSemaphoreCreateMutexStatic( pxMutexBuffer ) xQueueCreateMutexStatic( pxMutexBuffer )
+
 
 /**
  * semphr. h
@@ -119,6 +119,19 @@ typedef struct xTASK_PARAMTERS
 	xMemoryRegion xRegions[ portNUM_CONFIGURABLE_REGIONS ];
 } xTaskParameters;
 
+/*
+ * Actions that can be performed on the notification value of a task by
+ * xTaskNotify().
+ */
+typedef enum
+{
+	eNoAction = 0,				/* Notify the task without updating its notify value. */
+	eSetBits,					/* Set bits in the task's notification value. */
+	eIncrement,					/* Increment the task's notification value. */
+	eSetValueWithOverwrite,		/* Set the task's notification value to a specific value even if the previous value has not yet been read by the task. */
+	eSetValueWithoutOverwrite	/* Set the task's notification value if the previous value has been read by the task. */
+} eNotifyAction;
+
 /*
  * Defines the priority used by the idle task.  This must not be modified.
  *
@@ -269,7 +282,54 @@ typedef struct xTASK_PARAMTERS
  * \defgroup xTaskCreate xTaskCreate
  * \ingroup Tasks
  */
-#define xTaskCreate( pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask ) xTaskGenericCreate( ( pvTaskCode ), ( pcName ), ( usStackDepth ), ( pvParameters ), ( uxPriority ), ( pxCreatedTask ), ( NULL ), ( NULL ) )
+#define xTaskCreate( pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask ) xTaskGenericCreate( ( pvTaskCode ), ( pcName ), ( usStackDepth ), ( pvParameters ), ( uxPriority ), ( pxCreatedTask ), ( NULL ), ( NULL ), ( NULL ) )
+
+/**
+ * task. h
+ *<pre>
+ portBASE_TYPE xTaskCreateStatic(
+							  pdTASK_CODE pvTaskCode,
+							  const char * const pcName,
+							  unsigned short usStackDepth,
+							  void *pvParameters,
+							  unsigned portBASE_TYPE uxPriority,
+							  xTaskHandle *pvCreatedTask,
+							  portSTACK_TYPE *puxStackBuffer,
+							  xStaticTaskType *pxTaskBuffer
+						  );</pre>
+ *
+ * configSUPPORT_STATIC_ALLOCATION must be set to 1 in FreeRTOSConfig.h for
+ * this function to be available.
+ *
+ * Create a new task, like xTaskCreate(), but in memory supplied by the
+ * caller instead of memory allocated from the heap.  Both buffers must stay
+ * valid for as long as the task exists; they are usually declared static.
+ * After the task has been deleted, the memory may only be reused once the
+ * idle task has run.
+ *
+ * @param puxStackBuffer Array of at least usStackDepth elements that is used
+ * as the stack of the task.
+ *
+ * @param pxTaskBuffer Variable that holds the TCB of the task.
+ *
+ * The other parameters and the return value are those of xTaskCreate().
+ *
+ * Example usage:
+   <pre>
+ #define STACK_SIZE 100
+
+ static portSTACK_TYPE xStack[ STACK_SIZE ];
+ static xStaticTaskType xTaskBuffer;
+
+ void vOtherFunction( void )
+ {
+	 xTaskCreateStatic( vTaskCode, "NAME", STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL, xStack, &xTaskBuffer );
+ }
+   </pre>
+ * \defgroup xTaskCreateStatic xTaskCreateStatic
+ * \ingroup Tasks
+ */
+#define xTaskCreateStatic( pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask, puxStackBuffer, pxTaskBuffer ) xTaskGenericCreate( ( pvTaskCode ), ( pcName ), ( usStackDepth ), ( pvParameters ), ( uxPriority ), ( pxCreatedTask ), ( puxStackBuffer ), ( pxTaskBuffer ), ( NULL ) )
 
 /**
  * task. h
@@ -338,7 +398,7 @@ xTaskHandle xHandle;
  * \defgroup xTaskCreateRestricted xTaskCreateRestricted
  * \ingroup Tasks
  */
-#define xTaskCreateRestricted( x, pxCreatedTask ) xTaskGenericCreate( ((x)->pvTaskCode), ((x)->pcName), ((x)->usStackDepth), ((x)->pvParameters), ((x)->uxPriority), (pxCreatedTask), ((x)->puxStackBuffer), ((x)->xRegions) )
+#define xTaskCreateRestricted( x, pxCreatedTask ) xTaskGenericCreate( ((x)->pvTaskCode), ((x)->pcName), ((x)->usStackDepth), ((x)->pvParameters), ((x)->uxPriority), (pxCreatedTask), ((x)->puxStackBuffer), ( NULL ), ((x)->xRegions) )
 
 /**
  * task. h
@@ -1060,6 +1120,57 @@ void vTaskList( signed char *pcWriteBuffer ) PRIVILEGED_FUNCTION;
  */
 void vTaskGetRunTimeStats( signed char *pcWriteBuffer ) PRIVILEGED_FUNCTION;
 
+/* Accumulated execution time of one task, see uxTaskGetRunTimeCounters(). */
+typedef struct xTASK_RUN_TIME
+{
+	const signed char *pcTaskName;		/*< Name the task was created with. */
+	unsigned long ulRunTimeCounter;		/*< Run time counter ticks the task has been running for. */
+} xTaskRunTimeType;
+
+/**
+ * task. h
+ * <PRE>unsigned portBASE_TYPE uxTaskGetRunTimeCounters( xTaskRunTimeType *pxCounters, unsigned portBASE_TYPE uxMaxCounters, portBASE_TYPE xReset );</PRE>
+ *
+ * configGENERATE_RUN_TIME_STATS must be defined as 1 for this function
+ * to be available.
+ *
+ * A light-weight alternative to vTaskGetRunTimeStats(): the accumulated
+ * execution time of each task is copied into an array without any
+ * formatting, so the scheduler is only suspended for a short time.  The
+ * time slice of the calling task that is in progress is not yet included.
+ *
+ * @param pxCounters Array into which the counters are written.
+ *
+ * @param uxMaxCounters Number of elements of pxCounters.  Tasks that do not
+ * fit into the array are not reported.
+ *
+ * @param xReset If not pdFALSE, the counters of the reported tasks are set
+ * back to zero, so that the next call returns the time used since this one.
+ * This keeps the counters from overflowing when the run time counter has a
+ * high frequency, but makes the totals of vTaskGetRunTimeStats() meaningless.
+ *
+ * @return The number of elements written to pxCounters.
+ *
+ * \page uxTaskGetRunTimeCounters uxTaskGetRunTimeCounters
+ * \ingroup TaskUtils
+ */
+unsigned portBASE_TYPE uxTaskGetRunTimeCounters( xTaskRunTimeType *pxCounters, unsigned portBASE_TYPE uxMaxCounters, portBASE_TYPE xReset ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>unsigned long ulTaskGetContextSwitchCount( void );</PRE>
+ *
+ * configGENERATE_RUN_TIME_STATS must be defined as 1 for this function
+ * to be available.
+ *
+ * @return The number of times a task other than the one that was running
+ * has been switched in since the scheduler was started.
+ *
+ * \page ulTaskGetContextSwitchCount ulTaskGetContextSwitchCount
+ * \ingroup TaskUtils
+ */
+unsigned long ulTaskGetContextSwitchCount( void ) PRIVILEGED_FUNCTION;
+
 /**
  * task. h
  * <PRE>void vTaskStartTrace( char * pcBuffer, unsigned portBASE_TYPE uxBufferSize );</PRE>
@@ -1114,6 +1225,34 @@ unsigned long ulTaskEndTrace( void ) PRIVILEGED_FUNCTION;
  */
 unsigned portBASE_TYPE uxTaskGetStackHighWaterMark( xTaskHandle xTask ) PRIVILEGED_FUNCTION;
 
+/* Stack usage of one task, see uxTaskGetStackUsage(). */
+typedef struct xTASK_STACK_USAGE
+{
+	const signed char *pcTaskName;		/*< Name the task was created with. */
+	unsigned short usStackDepth;		/*< Size of the stack in words, as passed to xTaskCreate(). */
+	unsigned short usHighWaterMark;		/*< Smallest number of unused words there has been. */
+} xTaskStackUsageType;
+
+/**
+ * task.h
+ * <PRE>unsigned portBASE_TYPE uxTaskGetStackUsage( xTaskStackUsageType *pxUsage, unsigned portBASE_TYPE uxMaxUsage );</PRE>
+ *
+ * INCLUDE_uxTaskGetStackHighWaterMark must be set to 1 in FreeRTOSConfig.h for
+ * this function to be available.
+ *
+ * Fills in the stack size and the high water mark (in words, as returned by
+ * uxTaskGetStackHighWaterMark()) of every task that has not been deleted,
+ * without the need for task handles.
+ *
+ * @param pxUsage Array into which the stack usage is written.
+ *
+ * @param uxMaxUsage Number of elements of pxUsage.  Tasks that do not fit
+ * into the array are not reported.
+ *
+ * @return The number of elements written to pxUsage.
+ */
+unsigned portBASE_TYPE uxTaskGetStackUsage( xTaskStackUsageType *pxUsage, unsigned portBASE_TYPE uxMaxUsage ) PRIVILEGED_FUNCTION;
+
 /**
  * task.h
  * <pre>void vTaskSetApplicationTaskTag( xTaskHandle xTask, pdTASK_HOOK_CODE pxHookFunction );</pre>
@@ -1144,6 +1283,144 @@ pdTASK_HOOK_CODE xTaskGetApplicationTaskTag( xTaskHandle xTask ) PRIVILEGED_FUNC
  */
 portBASE_TYPE xTaskCallApplicationTaskHook( xTaskHandle xTask, void *pvParameter ) PRIVILEGED_FUNCTION;
 
+/*-----------------------------------------------------------
+ * TASK NOTIFICATIONS
+ *----------------------------------------------------------*/
+
+/**
+ * task. h
+ * <PRE>portBASE_TYPE xTaskNotify( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction );</PRE>
+ *
+ * configUSE_TASK_NOTIFICATIONS must be set to 1 in FreeRTOSConfig.h for
+ * this function to be available.
+ *
+ * Every task has a 32-bit notification value, stored in its TCB, that other
+ * tasks and interrupts can update while optionally unblocking the task.  A
+ * task waits for a notification with xTaskNotifyWait() or ulTaskNotifyTake().
+ * A notification does not need a queue or semaphore object: it costs 8 bytes
+ * of RAM per task, and unblocking a task takes one list move instead of the
+ * walk over the event list of a queue.  The price is that only the task
+ * itself can wait for its notifications, and only a single value (no
+ * buffer) can be sent.
+ *
+ * @param xTaskToNotify The handle of the task being notified.
+ *
+ * @param ulValue Data that can be sent with the notification, used
+ * according to eAction.
+ *
+ * @param eAction How the notification value is updated:
+ *
+ * eNoAction - the task is notified, its notification value is not changed.
+ *
+ * eSetBits - the notification value is bitwise ORed with ulValue.
+ *
+ * eIncrement - the notification value is incremented and ulValue is not
+ * used.  This makes the notification a lighter counting semaphore, see
+ * xTaskNotifyGive().
+ *
+ * eSetValueWithOverwrite - the notification value is set to ulValue, even
+ * if the task has not read the previous value yet.
+ *
+ * eSetValueWithoutOverwrite - the notification value is set to ulValue
+ * only if the task has read the previous value; otherwise pdFAIL is
+ * returned.
+ *
+ * @return pdFAIL if eAction is eSetValueWithoutOverwrite and the value could
+ * not be written, pdPASS otherwise.
+ *
+ * \defgroup xTaskNotify xTaskNotify
+ * \ingroup TaskNotifications
+ */
+portBASE_TYPE xTaskGenericNotify( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, unsigned long *pulPreviousNotificationValue ) PRIVILEGED_FUNCTION;
+#define xTaskNotify( xTaskToNotify, ulValue, eAction ) xTaskGenericNotify( ( xTaskToNotify ), ( ulValue ), ( eAction ), NULL )
+
+/**
+ * task. h
+ * <PRE>portBASE_TYPE xTaskNotifyAndQuery( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, unsigned long *pulPreviousNotifyValue );</PRE>
+ *
+ * As xTaskNotify(), but the notification value the task had before it was
+ * updated is written to *pulPreviousNotifyValue.
+ *
+ * \defgroup xTaskNotifyAndQuery xTaskNotifyAndQuery
+ * \ingroup TaskNotifications
+ */
+#define xTaskNotifyAndQuery( xTaskToNotify, ulValue, eAction, pulPreviousNotifyValue ) xTaskGenericNotify( ( xTaskToNotify ), ( ulValue ), ( eAction ), ( pulPreviousNotifyValue ) )
+
+/**
+ * task. h
+ * <PRE>portBASE_TYPE xTaskNotifyFromISR( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, signed portBASE_TYPE *pxHigherPriorityTaskWoken );</PRE>
+ *
+ * A version of xTaskNotify() that can be used from an interrupt service
+ * routine.
+ *
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if the notification
+ * unblocked a task with a priority above that of the interrupted task.
+ * A context switch should then be requested before the interrupt exits.
+ *
+ * \defgroup xTaskNotifyFromISR xTaskNotifyFromISR
+ * \ingroup TaskNotifications
+ */
+portBASE_TYPE xTaskGenericNotifyFromISR( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, unsigned long *pulPreviousNotificationValue, signed portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+#define xTaskNotifyFromISR( xTaskToNotify, ulValue, eAction, pxHigherPriorityTaskWoken ) xTaskGenericNotifyFromISR( ( xTaskToNotify ), ( ulValue ), ( eAction ), NULL, ( pxHigherPriorityTaskWoken ) )
+
+/**
+ * task. h
+ * <PRE>portBASE_TYPE xTaskNotifyWait( unsigned long ulBitsToClearOnEntry, unsigned long ulBitsToClearOnExit, unsigned long *pulNotificationValue, portTickType xTicksToWait );</PRE>
+ *
+ * Waits, optionally blocking, for the calling task to be notified.
+ *
+ * @param ulBitsToClearOnEntry Bits cleared in the notification value before
+ * waiting, if no notification is pending.
+ *
+ * @param ulBitsToClearOnExit Bits cleared in the notification value when a
+ * notification was received, after it has been written to
+ * *pulNotificationValue.  Set to 0xffffffffUL to reset the value to 0.
+ *
+ * @param pulNotificationValue Receives the notification value.  Can be NULL.
+ *
+ * @param xTicksToWait The maximum time to block.  portMAX_DELAY blocks
+ * indefinitely if INCLUDE_vTaskSuspend is set to 1.
+ *
+ * @return pdTRUE if a notification was received (or already pending),
+ * pdFALSE if the call timed out.
+ *
+ * \defgroup xTaskNotifyWait xTaskNotifyWait
+ * \ingroup TaskNotifications
+ */
+portBASE_TYPE xTaskNotifyWait( unsigned long ulBitsToClearOnEntry, unsigned long ulBitsToClearOnExit, unsigned long *pulNotificationValue, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>portBASE_TYPE xTaskNotifyGive( xTaskHandle xTaskToNotify );</PRE>
+ * <PRE>void vTaskNotifyGiveFromISR( xTaskHandle xTaskToNotify, signed portBASE_TYPE *pxHigherPriorityTaskWoken );</PRE>
+ *
+ * Increment the notification value of a task.  Together with
+ * ulTaskNotifyTake() this replaces a binary or counting semaphore that is
+ * given to a single task.
+ *
+ * \defgroup xTaskNotifyGive xTaskNotifyGive
+ * \ingroup TaskNotifications
+ */
+#define xTaskNotifyGive( xTaskToNotify ) xTaskGenericNotify( ( xTaskToNotify ), 0, eIncrement, NULL )
+#define vTaskNotifyGiveFromISR( xTaskToNotify, pxHigherPriorityTaskWoken ) ( void ) xTaskGenericNotifyFromISR( ( xTaskToNotify ), 0, eIncrement, NULL, ( pxHigherPriorityTaskWoken ) )
+
+/**
+ * task. h
+ * <PRE>unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait );</PRE>
+ *
+ * Waits, optionally blocking, for the notification value of the calling
+ * task to be non-zero, and then either decrements it (xClearCountOnExit is
+ * pdFALSE, the value is used as a counting semaphore) or clears it
+ * (xClearCountOnExit is pdTRUE, the value is used as a binary semaphore).
+ *
+ * @return The notification value before it was decremented or cleared, so
+ * 0 if the call timed out.
+ *
+ * \defgroup ulTaskNotifyTake ulTaskNotifyTake
+ * \ingroup TaskNotifications
+ */
+unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
 
 /*-----------------------------------------------------------
  * SCHEDULER INTERNALS AVAILABLE FOR PORTING PURPOSES
@@ -1161,6 +1438,32 @@ portBASE_TYPE xTaskCallApplicationTaskHook( xTaskHandle xTask, void *pvParameter
  */
 void vTaskIncrementTick( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
+ * INTENDED FOR USE WHEN IMPLEMENTING A PORT OF THE SCHEDULER AND IS
+ * AN INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * Only available when configUSE_TICKLESS_IDLE is set to 1.  Called by the
+ * port after the tick interrupt has been suppressed, to move the tick count
+ * forward by the number of tick periods spent asleep.  The port never sleeps
+ * beyond the time at which the next delayed task has to be unblocked, so no
+ * task can miss its wake time.
+ */
+void vTaskStepTick( portTickType xTicksToJump ) PRIVILEGED_FUNCTION;
+
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
+ * INTENDED FOR USE WHEN IMPLEMENTING A PORT OF THE SCHEDULER AND IS
+ * AN INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * Only available when configUSE_TICKLESS_IDLE is set to 1.  Called by the
+ * port with interrupts disabled, immediately before entering the sleep mode.
+ * Returns pdFALSE if an interrupt made a task ready (or requested a context
+ * switch) after the idle task decided to sleep, in which case the sleep
+ * must be abandoned.
+ */
+portBASE_TYPE xTaskConfirmSleep( void ) PRIVILEGED_FUNCTION;
+
 /*
  * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS AN
  * INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
@@ -1266,9 +1569,9 @@ void vTaskPriorityDisinherit( xTaskHandle * const pxMutexHolder ) PRIVILEGED_FUN
 
 /*
  * Generic version of the task creation function which is in turn called by the
- * xTaskCreate() and xTaskCreateRestricted() macros.
+ * xTaskCreate(), xTaskCreateStatic() and xTaskCreateRestricted() macros.
  */
-signed portBASE_TYPE xTaskGenericCreate( pdTASK_CODE pvTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, const xMemoryRegion * const xRegions ) PRIVILEGED_FUNCTION;
+signed portBASE_TYPE xTaskGenericCreate( pdTASK_CODE pvTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, xStaticTaskType *pxTaskBuffer, const xMemoryRegion * const xRegions ) PRIVILEGED_FUNCTION;
 
 #ifdef __cplusplus
 }
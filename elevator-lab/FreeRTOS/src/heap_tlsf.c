@@ -0,0 +1,505 @@
+/*
+    FreeRTOS V6.1.0 - Copyright (C) 2010 Real Time Engineers Ltd.
+
+    ***************************************************************************
+    *                                                                         *
+    * If you are:                                                             *
+    *                                                                         *
+    *    + New to FreeRTOS,                                                   *
+    *    + Wanting to learn FreeRTOS or multitasking in general quickly       *
+    *    + Looking for basic training,                                        *
+    *    + Wanting to improve your FreeRTOS skills and productivity           *
+    *                                                                         *
+    * then take a look at the FreeRTOS books - available as PDF or paperback  *
+    *                                                                         *
+    *        "Using the FreeRTOS Real Time Kernel - a Practical Guide"        *
+    *                  http://www.FreeRTOS.org/Documentation                  *
+    *                                                                         *
+    * A pdf reference manual is also available.  Both are usually delivered   *
+    * to your inbox within 20 minutes to two hours when purchased between 8am *
+    * and 8pm GMT (although please allow up to 24 hours in case of            *
+    * exceptional circumstances).  Thank you for your support!                *
+    *                                                                         *
+    ***************************************************************************
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    ***NOTE*** The exception to the GPL is included to allow you to distribute
+    a combined work that includes FreeRTOS without being obliged to provide the
+    source code for proprietary components outside of the FreeRTOS kernel.
+    FreeRTOS is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public 
+    License and the FreeRTOS license exception along with FreeRTOS; if not it 
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained 
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+/*
+ * An implementation of pvPortMalloc() and vPortFree() after the TLSF (two
+ * level segregated fit) allocator, for heaps that are not only allocated
+ * from once at startup.  Both functions take constant time, independent of
+ * the number of blocks, and adjacent free blocks are combined as soon as
+ * they are freed, so freeing and allocating does not fragment the heap the
+ * way heap_2.c does.
+ *
+ * Free blocks are kept in segregated lists: the first level divides sizes
+ * into powers of two, the second level divides each power of two into
+ * heapSL_INDEX_COUNT linear ranges.  A bitmap per level records which lists
+ * are non-empty, so a suitable list is found with a couple of CLZ
+ * instructions.  Every block starts with a header that holds its size and a
+ * pointer to the block physically before it, which allows neighbours to be
+ * merged in constant time.  Free blocks also hold their list links, in the
+ * space that is handed to the application while the block is allocated.
+ *
+ * See heap_1.c and heap_3.c for alternative implementations, and the memory
+ * management pages of http://www.FreeRTOS.org for more information.
+ */
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* Without dynamic allocation nothing calls pvPortMalloc(), so the heap is
+left out and does not take any RAM. */
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+/* Allocate the memory for the heap.  The struct is used to force byte
+alignment without using any non-portable code. */
+static union xRTOS_HEAP
+{
+	#if portBYTE_ALIGNMENT == 8
+		volatile portDOUBLE dDummy;
+	#else
+		volatile unsigned long ulDummy;
+	#endif
+	unsigned char ucHeap[ configTOTAL_HEAP_SIZE ];
+} xHeap;
+
+/* Index of the highest and lowest set bit of a non-zero word. */
+#if defined( __CC_ARM )
+	#define heapFLS( ulValue )	( ( unsigned portBASE_TYPE ) ( 31 - __clz( ulValue ) ) )
+#else
+	#define heapFLS( ulValue )	( ( unsigned portBASE_TYPE ) ( 31 - __builtin_clz( ulValue ) ) )
+#endif
+#define heapFFS( ulValue )		heapFLS( ( ulValue ) & ( ~( ulValue ) + 1UL ) )
+
+/* Number of second level lists per power of two (log2).  More lists give a
+closer fit, at the cost of four bytes of RAM each. */
+#define heapSL_INDEX_COUNT_LOG2		( 3 )
+#define heapSL_INDEX_COUNT			( 1 << heapSL_INDEX_COUNT_LOG2 )
+
+/* Blocks below heapSMALL_BLOCK_SIZE all map to the first first-level list,
+whose second level lists are portBYTE_ALIGNMENT bytes apart. */
+#define heapALIGNMENT_LOG2			( 3 )
+#define heapFL_INDEX_SHIFT			( heapSL_INDEX_COUNT_LOG2 + heapALIGNMENT_LOG2 )
+#define heapSMALL_BLOCK_SIZE		( ( size_t ) 1 << heapFL_INDEX_SHIFT )
+
+/* Blocks have to be smaller than 2^( heapFL_INDEX_MAX + 1 ) bytes, which
+limits the heap to 32 KB.  Raise it for larger heaps. */
+#define heapFL_INDEX_MAX			( 14 )
+#define heapFL_INDEX_COUNT			( heapFL_INDEX_MAX - heapFL_INDEX_SHIFT + 2 )
+#define heapMAXIMUM_BLOCK_SIZE		( ( ( size_t ) 1 << ( heapFL_INDEX_MAX + 1 ) ) - portBYTE_ALIGNMENT )
+
+/* Define the block header.  The free list links are only valid while the
+block is free; in an allocated block they are part of the memory handed to
+the application. */
+typedef struct A_BLOCK_HEADER
+{
+	struct A_BLOCK_HEADER *pxPrevPhysBlock;	/*<< The block just before this one in memory. */
+	size_t xSize;							/*<< Size of the block including the header, and the flags below. */
+	struct A_BLOCK_HEADER *pxNextFreeBlock;	/*<< The next free block in the same list. */
+	struct A_BLOCK_HEADER *pxPrevFreeBlock;	/*<< The previous free block in the same list. */
+} xBlockHeader;
+
+/* Block sizes are multiples of the alignment, so the low bits of the size
+are used as flags. */
+#define heapBLOCK_FREE				( ( size_t ) 1 )
+#define heapPREV_BLOCK_FREE			( ( size_t ) 2 )
+#define heapBLOCK_SIZE( pxBlock )	( ( pxBlock )->xSize & ~( size_t ) portBYTE_ALIGNMENT_MASK )
+#define heapNEXT_PHYS_BLOCK( pxBlock )	( ( xBlockHeader * ) ( ( ( unsigned char * ) ( pxBlock ) ) + heapBLOCK_SIZE( pxBlock ) ) )
+
+/* Overhead of an allocated block, and the smallest block that can hold the
+free list links. */
+#define heapSTRUCT_SIZE				( ( size_t ) ( 2 * sizeof( void * ) ) )
+#define heapMINIMUM_BLOCK_SIZE		( ( size_t ) ( ( sizeof( xBlockHeader ) + portBYTE_ALIGNMENT_MASK ) & ~portBYTE_ALIGNMENT_MASK ) )
+
+/* The segregated free lists, and which of them are non-empty. */
+static xBlockHeader *pxFreeLists[ heapFL_INDEX_COUNT ][ heapSL_INDEX_COUNT ];
+static unsigned long ulFLBitmap = 0UL;
+static unsigned long ulSLBitmap[ heapFL_INDEX_COUNT ];
+
+/* Keeps track of the number of free bytes remaining, and of the lowest it
+has ever been. */
+static size_t xFreeBytesRemaining = configTOTAL_HEAP_SIZE;
+static size_t xMinimumEverFreeBytesRemaining = configTOTAL_HEAP_SIZE;
+
+/*
+ * Find the lists a free block of the given size belongs to.
+ */
+static void prvMappingInsert( size_t xSize, unsigned portBASE_TYPE *puxFL, unsigned portBASE_TYPE *puxSL );
+
+/*
+ * Find the first list whose blocks are all at least xSize bytes large.
+ * Returns pdFALSE if no list can satisfy the request.
+ */
+static portBASE_TYPE prvMappingSearch( size_t xSize, unsigned portBASE_TYPE *puxFL, unsigned portBASE_TYPE *puxSL );
+
+/*
+ * Insert a block into, or remove it from, the free list for its size.
+ */
+static void prvInsertFreeBlock( xBlockHeader *pxBlock );
+static void prvRemoveFreeBlock( xBlockHeader *pxBlock );
+
+/*
+ * Set up a single free block spanning the whole heap, followed by an empty
+ * allocated block that stops the merging at the end of the heap.
+ */
+static void prvHeapInit( void );
+/*-----------------------------------------------------------*/
+
+static void prvMappingInsert( size_t xSize, unsigned portBASE_TYPE *puxFL, unsigned portBASE_TYPE *puxSL )
+{
+unsigned portBASE_TYPE uxFL, uxSL;
+
+	if( xSize < heapSMALL_BLOCK_SIZE )
+	{
+		uxFL = 0;
+		uxSL = ( unsigned portBASE_TYPE ) ( xSize / ( heapSMALL_BLOCK_SIZE / heapSL_INDEX_COUNT ) );
+	}
+	else
+	{
+		uxFL = heapFLS( ( unsigned long ) xSize );
+		uxSL = ( unsigned portBASE_TYPE ) ( xSize >> ( uxFL - heapSL_INDEX_COUNT_LOG2 ) ) ^ ( 1 << heapSL_INDEX_COUNT_LOG2 );
+		uxFL -= ( heapFL_INDEX_SHIFT - 1 );
+	}
+
+	*puxFL = uxFL;
+	*puxSL = uxSL;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvMappingSearch( size_t xSize, unsigned portBASE_TYPE *puxFL, unsigned portBASE_TYPE *puxSL )
+{
+unsigned long ulSLMap, ulFLMap;
+unsigned portBASE_TYPE uxFL, uxSL;
+
+	/* Round the size up to the start of the next list, so that any block
+	found is large enough without searching within the list. */
+	if( xSize >= heapSMALL_BLOCK_SIZE )
+	{
+		xSize += ( ( size_t ) 1 << ( heapFLS( ( unsigned long ) xSize ) - heapSL_INDEX_COUNT_LOG2 ) ) - 1;
+	}
+
+	prvMappingInsert( xSize, &uxFL, &uxSL );
+	if( uxFL >= heapFL_INDEX_COUNT )
+	{
+		return pdFALSE;
+	}
+
+	/* A list of the same power of two, or else of the next non-empty power
+	of two. */
+	ulSLMap = ulSLBitmap[ uxFL ] & ( ~0UL << uxSL );
+	if( ulSLMap == 0UL )
+	{
+		ulFLMap = ulFLBitmap & ( ~0UL << ( uxFL + 1 ) );
+		if( ulFLMap == 0UL )
+		{
+			return pdFALSE;
+		}
+
+		uxFL = heapFFS( ulFLMap );
+		ulSLMap = ulSLBitmap[ uxFL ];
+	}
+
+	*puxFL = uxFL;
+	*puxSL = heapFFS( ulSLMap );
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertFreeBlock( xBlockHeader *pxBlock )
+{
+unsigned portBASE_TYPE uxFL, uxSL;
+
+	prvMappingInsert( heapBLOCK_SIZE( pxBlock ), &uxFL, &uxSL );
+
+	pxBlock->pxPrevFreeBlock = NULL;
+	pxBlock->pxNextFreeBlock = pxFreeLists[ uxFL ][ uxSL ];
+	if( pxBlock->pxNextFreeBlock != NULL )
+	{
+		pxBlock->pxNextFreeBlock->pxPrevFreeBlock = pxBlock;
+	}
+	pxFreeLists[ uxFL ][ uxSL ] = pxBlock;
+
+	ulFLBitmap |= 1UL << uxFL;
+	ulSLBitmap[ uxFL ] |= 1UL << uxSL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveFreeBlock( xBlockHeader *pxBlock )
+{
+unsigned portBASE_TYPE uxFL, uxSL;
+
+	prvMappingInsert( heapBLOCK_SIZE( pxBlock ), &uxFL, &uxSL );
+
+	if( pxBlock->pxNextFreeBlock != NULL )
+	{
+		pxBlock->pxNextFreeBlock->pxPrevFreeBlock = pxBlock->pxPrevFreeBlock;
+	}
+
+	if( pxBlock->pxPrevFreeBlock != NULL )
+	{
+		pxBlock->pxPrevFreeBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+	}
+	else
+	{
+		/* The block was the head of its list. */
+		pxFreeLists[ uxFL ][ uxSL ] = pxBlock->pxNextFreeBlock;
+		if( pxFreeLists[ uxFL ][ uxSL ] == NULL )
+		{
+			ulSLBitmap[ uxFL ] &= ~( 1UL << uxSL );
+			if( ulSLBitmap[ uxFL ] == 0UL )
+			{
+				ulFLBitmap &= ~( 1UL << uxFL );
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void )
+{
+xBlockHeader *pxFirstFreeBlock, *pxEndMarker;
+size_t xHeapSize;
+
+	/* A whole header is reserved for the end marker, even though only its
+	first two members are ever used. */
+	xHeapSize = ( ( size_t ) configTOTAL_HEAP_SIZE & ~( size_t ) portBYTE_ALIGNMENT_MASK ) - heapMINIMUM_BLOCK_SIZE;
+	if( xHeapSize > heapMAXIMUM_BLOCK_SIZE )
+	{
+		xHeapSize = heapMAXIMUM_BLOCK_SIZE;
+	}
+
+	pxFirstFreeBlock = ( void * ) xHeap.ucHeap;
+	pxFirstFreeBlock->pxPrevPhysBlock = NULL;
+	pxFirstFreeBlock->xSize = xHeapSize | heapBLOCK_FREE;
+
+	/* The end marker only consists of a header, so it can never be merged
+	with or handed out. */
+	pxEndMarker = heapNEXT_PHYS_BLOCK( pxFirstFreeBlock );
+	pxEndMarker->pxPrevPhysBlock = pxFirstFreeBlock;
+	pxEndMarker->xSize = heapPREV_BLOCK_FREE;
+
+	prvInsertFreeBlock( pxFirstFreeBlock );
+
+	xFreeBytesRemaining = xHeapSize;
+	xMinimumEverFreeBytesRemaining = xHeapSize;
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+xBlockHeader *pxBlock, *pxNewBlock, *pxNextBlock;
+unsigned portBASE_TYPE uxFL, uxSL;
+static portBASE_TYPE xHeapHasBeenInitialised = pdFALSE;
+void *pvReturn = NULL;
+
+	vTaskSuspendAll();
+	{
+		/* If this is the first call to malloc then the heap will require
+		initialisation to setup the list of free blocks. */
+		if( xHeapHasBeenInitialised == pdFALSE )
+		{
+			prvHeapInit();
+			xHeapHasBeenInitialised = pdTRUE;
+		}
+
+		if( ( xWantedSize > 0 ) && ( xWantedSize < configTOTAL_HEAP_SIZE ) )
+		{
+			/* The wanted size is increased so it can contain the header, and
+			rounded up so that blocks are always aligned. */
+			xWantedSize = ( xWantedSize + heapSTRUCT_SIZE + portBYTE_ALIGNMENT_MASK ) & ~( size_t ) portBYTE_ALIGNMENT_MASK;
+			if( xWantedSize < heapMINIMUM_BLOCK_SIZE )
+			{
+				xWantedSize = heapMINIMUM_BLOCK_SIZE;
+			}
+
+			if( prvMappingSearch( xWantedSize, &uxFL, &uxSL ) != pdFALSE )
+			{
+				pxBlock = pxFreeLists[ uxFL ][ uxSL ];
+				prvRemoveFreeBlock( pxBlock );
+
+				/* If the block is larger than required it is split in two, and
+				the remainder goes back into a free list. */
+				if( ( heapBLOCK_SIZE( pxBlock ) - xWantedSize ) >= heapMINIMUM_BLOCK_SIZE )
+				{
+					pxNewBlock = ( void * ) ( ( ( unsigned char * ) pxBlock ) + xWantedSize );
+					pxNewBlock->pxPrevPhysBlock = pxBlock;
+					pxNewBlock->xSize = ( heapBLOCK_SIZE( pxBlock ) - xWantedSize ) | heapBLOCK_FREE;
+					heapNEXT_PHYS_BLOCK( pxNewBlock )->pxPrevPhysBlock = pxNewBlock;
+
+					pxBlock->xSize = xWantedSize | ( pxBlock->xSize & heapPREV_BLOCK_FREE );
+					prvInsertFreeBlock( pxNewBlock );
+				}
+
+				/* Mark the block as allocated, also in the header of the
+				block that follows it. */
+				pxBlock->xSize &= ~heapBLOCK_FREE;
+				pxNextBlock = heapNEXT_PHYS_BLOCK( pxBlock );
+				pxNextBlock->xSize &= ~heapPREV_BLOCK_FREE;
+
+				xFreeBytesRemaining -= heapBLOCK_SIZE( pxBlock );
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
+
+				/* Return the memory space - jumping over the header at its
+				start. */
+				pvReturn = ( void * ) ( ( ( unsigned char * ) pxBlock ) + heapSTRUCT_SIZE );
+			}
+		}
+	}
+	xTaskResumeAll();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+	}
+	#endif
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void *pv )
+{
+unsigned char *puc = ( unsigned char * ) pv;
+xBlockHeader *pxBlock, *pxNeighbour;
+
+	if( pv )
+	{
+		/* The memory being freed will have a header immediately before it. */
+		puc -= heapSTRUCT_SIZE;
+
+		/* This casting is to keep the compiler from issuing warnings. */
+		pxBlock = ( void * ) puc;
+
+		vTaskSuspendAll();
+		{
+			xFreeBytesRemaining += heapBLOCK_SIZE( pxBlock );
+
+			/* Merge with the block before, if that one is free. */
+			if( ( pxBlock->xSize & heapPREV_BLOCK_FREE ) != 0 )
+			{
+				pxNeighbour = pxBlock->pxPrevPhysBlock;
+				prvRemoveFreeBlock( pxNeighbour );
+				pxNeighbour->xSize += heapBLOCK_SIZE( pxBlock );
+				pxBlock = pxNeighbour;
+			}
+
+			/* Merge with the block after, if that one is free.  The end marker
+			is never free. */
+			pxNeighbour = heapNEXT_PHYS_BLOCK( pxBlock );
+			if( ( pxNeighbour->xSize & heapBLOCK_FREE ) != 0 )
+			{
+				prvRemoveFreeBlock( pxNeighbour );
+				pxBlock->xSize += heapBLOCK_SIZE( pxNeighbour );
+				pxNeighbour = heapNEXT_PHYS_BLOCK( pxBlock );
+			}
+
+			pxBlock->xSize |= heapBLOCK_FREE;
+			pxNeighbour->pxPrevPhysBlock = pxBlock;
+			pxNeighbour->xSize |= heapPREV_BLOCK_FREE;
+
+			prvInsertFreeBlock( pxBlock );
+		}
+		xTaskResumeAll();
+	}
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( xHeapStatsType *pxHeapStats )
+{
+xBlockHeader *pxBlock;
+unsigned portBASE_TYPE uxFL, uxSL;
+size_t xLargest = 0;
+
+	vTaskSuspendAll();
+	{
+		/* The largest free block is in the highest non-empty list.  Blocks
+		within a list are not sorted, but the lists are short. */
+		if( ulFLBitmap != 0UL )
+		{
+			uxFL = heapFLS( ulFLBitmap );
+			uxSL = heapFLS( ulSLBitmap[ uxFL ] );
+
+			for( pxBlock = pxFreeLists[ uxFL ][ uxSL ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFreeBlock )
+			{
+				if( heapBLOCK_SIZE( pxBlock ) > xLargest )
+				{
+					xLargest = heapBLOCK_SIZE( pxBlock );
+				}
+			}
+		}
+
+		pxHeapStats->xFreeBytes = xFreeBytesRemaining;
+		pxHeapStats->xMinimumEverFreeBytes = xMinimumEverFreeBytesRemaining;
+	}
+	xTaskResumeAll();
+
+	/* The application can use the largest block, minus the header. */
+	pxHeapStats->xLargestFreeBlock = ( xLargest > heapSTRUCT_SIZE ) ? ( xLargest - heapSTRUCT_SIZE ) : 0;
+
+	/* Share of the free memory that is not in the largest block. */
+	if( pxHeapStats->xFreeBytes > 0 )
+	{
+		pxHeapStats->uxFragmentation = ( unsigned portBASE_TYPE ) ( 100UL - ( 100UL * xLargest ) / pxHeapStats->xFreeBytes );
+	}
+	else
+	{
+		pxHeapStats->uxFragmentation = 0;
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+	/* This just exists to keep the linker quiet. */
+}
+
+#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
@@ -78,6 +78,24 @@
 /* Constants required to set up the initial stack. */
 #define portINITIAL_XPSR			( 0x01000000 )
 
+#if configUSE_TICKLESS_IDLE == 1
+
+	/* Constants required to suppress the tick.  The SysTick is a 24 bit down
+	counter, which limits the time that can be slept in one go. */
+	#define portNVIC_SYSTICK_CURRENT	( ( volatile unsigned long *) 0xe000e018 )
+	#define portNVIC_SYSTICK_COUNT_FLAG	0x00010000
+	#define portMAX_24_BIT_NUMBER		( 0x00ffffffUL )
+	#define portSY_FULL_READ_WRITE		( 15 )
+
+	/* Approximate number of cycles the SysTick is stopped for while the
+	reload value is recalculated. */
+	#define portMISSED_COUNTS_FACTOR	( 45UL )
+
+	#define portTIMER_COUNTS_FOR_ONE_TICK	( configCPU_CLOCK_HZ / configTICK_RATE_HZ )
+	#define portMAX_SUPPRESSED_TICKS		( portMAX_24_BIT_NUMBER / portTIMER_COUNTS_FOR_ONE_TICK )
+
+#endif
+
 /* Each task maintains its own interrupt status in the critical nesting
 variable. */
 static unsigned portBASE_TYPE uxCriticalNesting = 0xaaaaaaaa;
@@ -270,6 +288,109 @@ void prvSetupTimerInterrupt( void )
 }
 /*-----------------------------------------------------------*/
 
+#if configUSE_TICKLESS_IDLE == 1
+
+/*
+ * Called by the idle task, with the scheduler suspended, when no task needs
+ * the processor for at least xExpectedIdleTime ticks.  The SysTick is
+ * reprogrammed to fire only when the next task has to be unblocked, and the
+ * processor waits in WFI.  Any other interrupt (e.g. a pin edge) also ends
+ * the sleep; the tick count is then corrected by the number of complete tick
+ * periods that have passed.
+ */
+void vPortSuppressTicksAndSleep( portTickType xExpectedIdleTime )
+{
+unsigned long ulReloadValue, ulCompletedSysTickDecrements, ulCompleteTickPeriods;
+unsigned long ulSysTickCTRL, ulCalculatedLoadValue;
+
+	if( xExpectedIdleTime > portMAX_SUPPRESSED_TICKS )
+	{
+		xExpectedIdleTime = portMAX_SUPPRESSED_TICKS;
+	}
+
+	/* Stop the SysTick while the reload value is calculated.  The time it is
+	stopped for is compensated as far as possible, a small drift of the
+	kernel time against real time is unavoidable. */
+	*(portNVIC_SYSTICK_CTRL) &= ~portNVIC_SYSTICK_ENABLE;
+
+	/* The last tick period is left to the normal tick interrupt. */
+	ulReloadValue = *(portNVIC_SYSTICK_CURRENT) + ( portTIMER_COUNTS_FOR_ONE_TICK * ( xExpectedIdleTime - 1UL ) );
+	if( ulReloadValue > portMISSED_COUNTS_FACTOR )
+	{
+		ulReloadValue -= portMISSED_COUNTS_FACTOR;
+	}
+
+	/* PRIMASK rather than BASEPRI: the WFI must still return when an
+	interrupt becomes pending, but the handler must only run once the tick
+	count has been corrected. */
+	__disable_irq();
+
+	if( xTaskConfirmSleep() == pdFALSE )
+	{
+		/* A task became ready in the meantime, restart the SysTick from
+		where it was stopped. */
+		*(portNVIC_SYSTICK_LOAD) = *(portNVIC_SYSTICK_CURRENT);
+		*(portNVIC_SYSTICK_CTRL) = portNVIC_SYSTICK_CLK | portNVIC_SYSTICK_INT | portNVIC_SYSTICK_ENABLE;
+		*(portNVIC_SYSTICK_LOAD) = portTIMER_COUNTS_FOR_ONE_TICK - 1UL;
+		__enable_irq();
+		return;
+	}
+
+	*(portNVIC_SYSTICK_LOAD) = ulReloadValue;
+	*(portNVIC_SYSTICK_CURRENT) = 0UL;
+	*(portNVIC_SYSTICK_CTRL) = portNVIC_SYSTICK_CLK | portNVIC_SYSTICK_INT | portNVIC_SYSTICK_ENABLE;
+
+	__dsb( portSY_FULL_READ_WRITE );
+	__wfi();
+	__isb( portSY_FULL_READ_WRITE );
+
+	/* Stop the SysTick again; reading CTRL also clears the count flag. */
+	ulSysTickCTRL = *(portNVIC_SYSTICK_CTRL);
+	*(portNVIC_SYSTICK_CTRL) = ( ulSysTickCTRL & ~portNVIC_SYSTICK_ENABLE );
+
+	/* Let the interrupt that woke the processor run.  A tick interrupt is
+	counted in uxMissedTicks, as the scheduler is still suspended. */
+	__enable_irq();
+
+	if( ( ulSysTickCTRL & portNVIC_SYSTICK_COUNT_FLAG ) != 0 )
+	{
+		/* The SysTick expired: the whole expected idle time has passed.  Its
+		interrupt accounts for the last tick, so only step the others, and
+		complete the current tick period with what is left of it. */
+		ulCalculatedLoadValue = ( portTIMER_COUNTS_FOR_ONE_TICK - 1UL ) - ( ulReloadValue - *(portNVIC_SYSTICK_CURRENT) );
+		if( ( ulCalculatedLoadValue < portMISSED_COUNTS_FACTOR ) || ( ulCalculatedLoadValue > portTIMER_COUNTS_FOR_ONE_TICK ) )
+		{
+			ulCalculatedLoadValue = portTIMER_COUNTS_FOR_ONE_TICK - 1UL;
+		}
+
+		*(portNVIC_SYSTICK_LOAD) = ulCalculatedLoadValue;
+		ulCompleteTickPeriods = xExpectedIdleTime - 1UL;
+	}
+	else
+	{
+		/* Some other interrupt ended the sleep early. */
+		ulCompletedSysTickDecrements = ( xExpectedIdleTime * portTIMER_COUNTS_FOR_ONE_TICK ) - *(portNVIC_SYSTICK_CURRENT);
+		ulCompleteTickPeriods = ulCompletedSysTickDecrements / portTIMER_COUNTS_FOR_ONE_TICK;
+
+		/* The SysTick fires at the end of the partial tick period. */
+		*(portNVIC_SYSTICK_LOAD) = ( ( ulCompleteTickPeriods + 1UL ) * portTIMER_COUNTS_FOR_ONE_TICK ) - ulCompletedSysTickDecrements;
+	}
+
+	/* Restart the SysTick; after the first interrupt it continues with the
+	normal tick period. */
+	*(portNVIC_SYSTICK_CURRENT) = 0UL;
+	portENTER_CRITICAL();
+	{
+		*(portNVIC_SYSTICK_CTRL) = portNVIC_SYSTICK_CLK | portNVIC_SYSTICK_INT | portNVIC_SYSTICK_ENABLE;
+		vTaskStepTick( ulCompleteTickPeriods );
+		*(portNVIC_SYSTICK_LOAD) = portTIMER_COUNTS_FOR_ONE_TICK - 1UL;
+	}
+	portEXIT_CRITICAL();
+}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
 __asm void vPortSetInterruptMask( void )
 {
 	PRESERVE8
@@ -113,7 +113,15 @@ typedef struct QueueDefinition
 	signed portBASE_TYPE xRxLock;			/*< Stores the number of items received from the queue (removed from the queue) while the queue was locked.  Set to queueUNLOCKED when the queue is not locked. */
 	signed portBASE_TYPE xTxLock;			/*< Stores the number of items transmitted to the queue (added to the queue) while the queue was locked.  Set to queueUNLOCKED when the queue is not locked. */
 
+	#if ( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+		unsigned char ucStaticallyAllocated;	/*< Set to pdTRUE if the memory of the queue was supplied by the application, so must not be freed when the queue is deleted. */
+	#endif
+
 } xQUEUE;
+
+/* xStaticQueueType in FreeRTOS.h must be kept the same size as xQUEUE.  The
+array below has a negative size, and so fails to compile, if it is not. */
+typedef char queueSTATIC_QUEUE_SIZE_CHECK[ ( sizeof( xStaticQueueType ) == sizeof( xQUEUE ) ) ? 1 : -1 ];
 /*-----------------------------------------------------------*/
 
 /*
@@ -136,6 +144,8 @@ signed portBASE_TYPE xQueueGenericSendFromISR( xQueueHandle pxQueue, const void
 signed portBASE_TYPE xQueueGenericReceive( xQueueHandle pxQueue, void * const pvBuffer, portTickType xTicksToWait, portBASE_TYPE xJustPeeking ) PRIVILEGED_FUNCTION;
 signed portBASE_TYPE xQueueReceiveFromISR( xQueueHandle pxQueue, void * const pvBuffer, signed portBASE_TYPE *pxTaskWoken ) PRIVILEGED_FUNCTION;
 xQueueHandle xQueueCreateMutex( void ) PRIVILEGED_FUNCTION;
+xQueueHandle xQueueCreateStatic( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char *pucQueueStorage, xStaticQueueType *pxStaticQueue ) PRIVILEGED_FUNCTION;
+xQueueHandle xQueueCreateMutexStatic( xStaticQueueType *pxStaticQueue ) PRIVILEGED_FUNCTION;
 xQueueHandle xQueueCreateCountingSemaphore( unsigned portBASE_TYPE uxCountValue, unsigned portBASE_TYPE uxInitialCount ) PRIVILEGED_FUNCTION;
 portBASE_TYPE xQueueTakeMutexRecursive( xQueueHandle xMutex, portTickType xBlockTime ) PRIVILEGED_FUNCTION;
 portBASE_TYPE xQueueGiveMutexRecursive( xQueueHandle xMutex ) PRIVILEGED_FUNCTION;
@@ -216,6 +226,20 @@ static void prvCopyDataToQueue( xQUEUE *pxQueue, const void *pvItemToQueue, port
  * Copies an item out of a queue.
  */
 static void prvCopyDataFromQueue( xQUEUE * const pxQueue, const void *pvBuffer ) PRIVILEGED_FUNCTION;
+
+/*
+ * Sets up a queue whose structure and storage area have been allocated by
+ * xQueueCreate() or supplied to xQueueCreateStatic().
+ */
+static void prvInitialiseNewQueue( xQUEUE *pxNewQueue, signed char *pcQueueStorage, unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize ) PRIVILEGED_FUNCTION;
+
+/*
+ * Sets up a mutex whose structure has been allocated by xQueueCreateMutex()
+ * or supplied to xQueueCreateMutexStatic().
+ */
+#if ( configUSE_MUTEXES == 1 )
+	static void prvInitialiseMutex( xQUEUE *pxNewQueue ) PRIVILEGED_FUNCTION;
+#endif
 /*-----------------------------------------------------------*/
 
 /*
@@ -244,58 +268,151 @@ static void prvCopyDataFromQueue( xQUEUE * const pxQueue, const void *pvBuffer )
  * PUBLIC QUEUE MANAGEMENT API documented in queue.h
  *----------------------------------------------------------*/
 
-xQueueHandle xQueueCreate( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize )
+static void prvInitialiseNewQueue( xQUEUE *pxNewQueue, signed char *pcQueueStorage, unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize )
 {
-xQUEUE *pxNewQueue;
-size_t xQueueSizeInBytes;
+	/* Initialise the queue members as described above where the queue type
+	is defined. */
+	pxNewQueue->pcHead = pcQueueStorage;
+	pxNewQueue->pcTail = pxNewQueue->pcHead + ( uxQueueLength * uxItemSize );
+	pxNewQueue->uxMessagesWaiting = 0;
+	pxNewQueue->pcWriteTo = pxNewQueue->pcHead;
+	pxNewQueue->pcReadFrom = pxNewQueue->pcHead + ( ( uxQueueLength - 1 ) * uxItemSize );
+	pxNewQueue->uxLength = uxQueueLength;
+	pxNewQueue->uxItemSize = uxItemSize;
+	pxNewQueue->xRxLock = queueUNLOCKED;
+	pxNewQueue->xTxLock = queueUNLOCKED;
+
+	/* Likewise ensure the event queues start with the correct state. */
+	vListInitialise( &( pxNewQueue->xTasksWaitingToSend ) );
+	vListInitialise( &( pxNewQueue->xTasksWaitingToReceive ) );
+}
+/*-----------------------------------------------------------*/
 
-	/* Allocate the new queue structure. */
-	if( uxQueueLength > ( unsigned portBASE_TYPE ) 0 )
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+	xQueueHandle xQueueCreate( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize )
 	{
-		pxNewQueue = ( xQUEUE * ) pvPortMalloc( sizeof( xQUEUE ) );
-		if( pxNewQueue != NULL )
+	xQUEUE *pxNewQueue;
+	signed char *pcQueueStorage;
+	size_t xQueueSizeInBytes;
+
+		/* Allocate the new queue structure. */
+		if( uxQueueLength > ( unsigned portBASE_TYPE ) 0 )
 		{
-			/* Create the list of pointers to queue items.  The queue is one byte
-			longer than asked for to make wrap checking easier/faster. */
-			xQueueSizeInBytes = ( size_t ) ( uxQueueLength * uxItemSize ) + ( size_t ) 1;
+			pxNewQueue = ( xQUEUE * ) pvPortMalloc( sizeof( xQUEUE ) );
+			if( pxNewQueue != NULL )
+			{
+				/* Create the list of pointers to queue items.  The queue is one byte
+				longer than asked for to make wrap checking easier/faster. */
+				xQueueSizeInBytes = ( size_t ) ( uxQueueLength * uxItemSize ) + ( size_t ) 1;
+
+				pcQueueStorage = ( signed char * ) pvPortMalloc( xQueueSizeInBytes );
+				if( pcQueueStorage != NULL )
+				{
+					prvInitialiseNewQueue( pxNewQueue, pcQueueStorage, uxQueueLength, uxItemSize );
 
-			pxNewQueue->pcHead = ( signed char * ) pvPortMalloc( xQueueSizeInBytes );
-			if( pxNewQueue->pcHead != NULL )
+					#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+					{
+						pxNewQueue->ucStaticallyAllocated = ( unsigned char ) pdFALSE;
+					}
+					#endif
+
+					traceQUEUE_CREATE( pxNewQueue );
+					return  pxNewQueue;
+				}
+				else
+				{
+					traceQUEUE_CREATE_FAILED();
+					vPortFree( pxNewQueue );
+				}
+			}
+		}
+
+		/* Will only reach here if we could not allocate enough memory or no memory
+		was required. */
+		return NULL;
+	}
+
+#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	xQueueHandle xQueueCreateStatic( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char *pucQueueStorage, xStaticQueueType *pxStaticQueue )
+	{
+	xQUEUE *pxNewQueue = NULL;
+
+		/* The storage area is never written beyond uxQueueLength * uxItemSize
+		bytes, so unlike xQueueCreate() no extra byte is required. */
+		if( ( uxQueueLength > ( unsigned portBASE_TYPE ) 0 ) && ( pxStaticQueue != NULL ) &&
+			( ( pucQueueStorage != NULL ) || ( uxItemSize == ( unsigned portBASE_TYPE ) 0 ) ) )
+		{
+			pxNewQueue = ( xQUEUE * ) pxStaticQueue;
+
+			if( uxItemSize == ( unsigned portBASE_TYPE ) 0 )
 			{
-				/* Initialise the queue members as described above where the
-				queue type is defined. */
-				pxNewQueue->pcTail = pxNewQueue->pcHead + ( uxQueueLength * uxItemSize );
-				pxNewQueue->uxMessagesWaiting = 0;
-				pxNewQueue->pcWriteTo = pxNewQueue->pcHead;
-				pxNewQueue->pcReadFrom = pxNewQueue->pcHead + ( ( uxQueueLength - 1 ) * uxItemSize );
-				pxNewQueue->uxLength = uxQueueLength;
-				pxNewQueue->uxItemSize = uxItemSize;
-				pxNewQueue->xRxLock = queueUNLOCKED;
-				pxNewQueue->xTxLock = queueUNLOCKED;
-
-				/* Likewise ensure the event queues start with the correct state. */
-				vListInitialise( &( pxNewQueue->xTasksWaitingToSend ) );
-				vListInitialise( &( pxNewQueue->xTasksWaitingToReceive ) );
-
-				traceQUEUE_CREATE( pxNewQueue );
-				return  pxNewQueue;
+				/* Semaphores do not need a storage area, but pcHead must not
+				be NULL as that marks a mutex.  Point it to the queue structure
+				itself, which is never written through pcHead. */
+				pucQueueStorage = ( unsigned char * ) pxStaticQueue;
 			}
-			else
+
+			prvInitialiseNewQueue( pxNewQueue, ( signed char * ) pucQueueStorage, uxQueueLength, uxItemSize );
+
+			#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
 			{
-				traceQUEUE_CREATE_FAILED();
-				vPortFree( pxNewQueue );
+				pxNewQueue->ucStaticallyAllocated = ( unsigned char ) pdTRUE;
 			}
+			#endif
+
+			traceQUEUE_CREATE( pxNewQueue );
 		}
+		else
+		{
+			traceQUEUE_CREATE_FAILED();
+		}
+
+		return pxNewQueue;
 	}
 
-	/* Will only reach here if we could not allocate enough memory or no memory
-	was required. */
-	return NULL;
-}
+#endif /* configSUPPORT_STATIC_ALLOCATION */
 /*-----------------------------------------------------------*/
 
 #if ( configUSE_MUTEXES == 1 )
 
+	static void prvInitialiseMutex( xQUEUE *pxNewQueue )
+	{
+		/* Information required for priority inheritance. */
+		pxNewQueue->pxMutexHolder = NULL;
+		pxNewQueue->uxQueueType = queueQUEUE_IS_MUTEX;
+
+		/* Queues used as a mutex no data is actually copied into or out
+		of the queue. */
+		pxNewQueue->pcWriteTo = NULL;
+		pxNewQueue->pcReadFrom = NULL;
+
+		/* Each mutex has a length of 1 (like a binary semaphore) and
+		an item size of 0 as nothing is actually copied into or out
+		of the mutex. */
+		pxNewQueue->uxMessagesWaiting = 0;
+		pxNewQueue->uxLength = 1;
+		pxNewQueue->uxItemSize = 0;
+		pxNewQueue->xRxLock = queueUNLOCKED;
+		pxNewQueue->xTxLock = queueUNLOCKED;
+
+		/* Ensure the event queues start with the correct state. */
+		vListInitialise( &( pxNewQueue->xTasksWaitingToSend ) );
+		vListInitialise( &( pxNewQueue->xTasksWaitingToReceive ) );
+
+		/* Start with the semaphore in the expected state. */
+		xQueueGenericSend( pxNewQueue, NULL, 0, queueSEND_TO_BACK );
+	}
+
+#endif /* configUSE_MUTEXES */
+/*-----------------------------------------------------------*/
+
+#if ( ( configUSE_MUTEXES == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+
 	xQueueHandle xQueueCreateMutex( void )
 	{
 	xQUEUE *pxNewQueue;
@@ -304,30 +421,13 @@ size_t xQueueSizeInBytes;
 		pxNewQueue = ( xQUEUE * ) pvPortMalloc( sizeof( xQUEUE ) );
 		if( pxNewQueue != NULL )
 		{
-			/* Information required for priority inheritance. */
-			pxNewQueue->pxMutexHolder = NULL;
-			pxNewQueue->uxQueueType = queueQUEUE_IS_MUTEX;
-
-			/* Queues used as a mutex no data is actually copied into or out
-			of the queue. */
-			pxNewQueue->pcWriteTo = NULL;
-			pxNewQueue->pcReadFrom = NULL;
-
-			/* Each mutex has a length of 1 (like a binary semaphore) and
-			an item size of 0 as nothing is actually copied into or out
-			of the mutex. */
-			pxNewQueue->uxMessagesWaiting = 0;
-			pxNewQueue->uxLength = 1;
-			pxNewQueue->uxItemSize = 0;
-			pxNewQueue->xRxLock = queueUNLOCKED;
-			pxNewQueue->xTxLock = queueUNLOCKED;
-
-			/* Ensure the event queues start with the correct state. */
-			vListInitialise( &( pxNewQueue->xTasksWaitingToSend ) );
-			vListInitialise( &( pxNewQueue->xTasksWaitingToReceive ) );
-
-			/* Start with the semaphore in the expected state. */
-			xQueueGenericSend( pxNewQueue, NULL, 0, queueSEND_TO_BACK );
+			#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+			{
+				pxNewQueue->ucStaticallyAllocated = ( unsigned char ) pdFALSE;
+			}
+			#endif
+
+			prvInitialiseMutex( pxNewQueue );
 
 			traceCREATE_MUTEX( pxNewQueue );
 		}
@@ -339,7 +439,37 @@ size_t xQueueSizeInBytes;
 		return pxNewQueue;
 	}
 
-#endif /* configUSE_MUTEXES */
+#endif /* configUSE_MUTEXES && configSUPPORT_DYNAMIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+#if ( ( configUSE_MUTEXES == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+
+	xQueueHandle xQueueCreateMutexStatic( xStaticQueueType *pxStaticQueue )
+	{
+	xQUEUE *pxNewQueue;
+
+		pxNewQueue = ( xQUEUE * ) pxStaticQueue;
+		if( pxNewQueue != NULL )
+		{
+			#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+			{
+				pxNewQueue->ucStaticallyAllocated = ( unsigned char ) pdTRUE;
+			}
+			#endif
+
+			prvInitialiseMutex( pxNewQueue );
+
+			traceCREATE_MUTEX( pxNewQueue );
+		}
+		else
+		{
+			traceCREATE_MUTEX_FAILED();
+		}
+
+		return pxNewQueue;
+	}
+
+#endif /* configUSE_MUTEXES && configSUPPORT_STATIC_ALLOCATION */
 /*-----------------------------------------------------------*/
 
 #if configUSE_RECURSIVE_MUTEXES == 1
@@ -423,7 +553,7 @@ size_t xQueueSizeInBytes;
 #endif /* configUSE_RECURSIVE_MUTEXES */
 /*-----------------------------------------------------------*/
 
-#if configUSE_COUNTING_SEMAPHORES == 1
+#if ( ( configUSE_COUNTING_SEMAPHORES == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
 
 	xQueueHandle xQueueCreateCountingSemaphore( unsigned portBASE_TYPE uxCountValue, unsigned portBASE_TYPE uxInitialCount )
 	{
@@ -445,7 +575,7 @@ size_t xQueueSizeInBytes;
 		return pxHandle;
 	}
 
-#endif /* configUSE_COUNTING_SEMAPHORES */
+#endif /* configUSE_COUNTING_SEMAPHORES && configSUPPORT_DYNAMIC_ALLOCATION */
 /*-----------------------------------------------------------*/
 
 signed portBASE_TYPE xQueueGenericSend( xQueueHandle pxQueue, const void * const pvItemToQueue, portTickType xTicksToWait, portBASE_TYPE xCopyPosition )
@@ -1041,8 +1171,18 @@ void vQueueDelete( xQueueHandle pxQueue )
 {
 	traceQUEUE_DELETE( pxQueue );
 	vQueueUnregisterQueue( pxQueue );
-	vPortFree( pxQueue->pcHead );
-	vPortFree( pxQueue );
+
+	#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+	{
+		#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+			if( pxQueue->ucStaticallyAllocated == ( unsigned char ) pdFALSE )
+		#endif
+		{
+			vPortFree( pxQueue->pcHead );
+			vPortFree( pxQueue );
+		}
+	}
+	#endif
 }
 /*-----------------------------------------------------------*/
 
@@ -72,12 +72,21 @@
 #define serNO_BLOCK						( ( portTickType ) 0 )
 #define serTX_BLOCK_TIME				( 40 / portTICK_RATE_MS )
 
+/* The queues are allocated statically, so the length passed to
+xSerialPortInitMinimal() must not exceed serMAX_QUEUE_LENGTH. */
+#define serMAX_QUEUE_LENGTH				( 64 )
+
 /*-----------------------------------------------------------*/
 
 /* The queue used to hold received characters. */
 static xQueueHandle xRxedChars;
 static xQueueHandle xCharsForTx;
 
+/* Memory of the queues. */
+static xStaticQueueType xRxedCharsBuffer, xCharsForTxBuffer;
+static unsigned char ucRxedCharsStorage[ serMAX_QUEUE_LENGTH ];
+static unsigned char ucCharsForTxStorage[ serMAX_QUEUE_LENGTH + 1 ];
+
 /*-----------------------------------------------------------*/
 
 /* UART interrupt handler. */
@@ -96,8 +105,11 @@ NVIC_InitTypeDef NVIC_InitStructure;
 GPIO_InitTypeDef GPIO_InitStructure;
 
 	/* Create the queues used to hold Rx/Tx characters. */
-	xRxedChars = xQueueCreate( uxQueueLength, ( unsigned portBASE_TYPE ) sizeof( signed portCHAR ) );
-	xCharsForTx = xQueueCreate( uxQueueLength + 1, ( unsigned portBASE_TYPE ) sizeof( signed portCHAR ) );
+	if( uxQueueLength <= serMAX_QUEUE_LENGTH )
+	{
+		xRxedChars = xQueueCreateStatic( uxQueueLength, ( unsigned portBASE_TYPE ) sizeof( signed portCHAR ), ucRxedCharsStorage, &xRxedCharsBuffer );
+		xCharsForTx = xQueueCreateStatic( uxQueueLength + 1, ( unsigned portBASE_TYPE ) sizeof( signed portCHAR ), ucCharsForTxStorage, &xCharsForTxBuffer );
+	}
 	
 	/* If the queue/semaphore was created correctly then setup the serial port
 	hardware. */
@@ -114,8 +114,25 @@ typedef struct tskTaskControlBlock
 		unsigned long ulRunTimeCounter;		/*< Used for calculating how much CPU time each task is utilising. */
 	#endif
 
+	#if ( INCLUDE_uxTaskGetStackHighWaterMark == 1 )
+		unsigned short usStackDepth;		/*< Size of the stack in words, reported by uxTaskGetStackUsage(). */
+	#endif
+
+	#if ( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+		unsigned char ucStaticallyAllocated;	/*< Set to pdTRUE if the TCB and stack were supplied by the application, so must not be freed when the task is deleted. */
+	#endif
+
+	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+		volatile unsigned long ulNotifiedValue;	/*< Value sent to the task by xTaskGenericNotify(). */
+		volatile unsigned char ucNotifyState;	/*< taskWAITING_NOTIFICATION while the task waits for a notification, see below. */
+	#endif
+
 } tskTCB;
 
+/* xStaticTaskType in FreeRTOS.h must be kept the same size as the TCB.  The array
+below has a negative size, and so fails to compile, if it is not. */
+typedef char tskSTATIC_TCB_SIZE_CHECK[ ( sizeof( xStaticTaskType ) == sizeof( tskTCB ) ) ? 1 : -1 ];
+
 
 /*
  * Some kernel aware debuggers require data to be viewed to be global, rather
@@ -150,11 +167,19 @@ PRIVILEGED_DATA static xList xPendingReadyList;							/*< Tasks that have been r
 
 #endif
 
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+
+	/* Without a heap the idle task is created in memory reserved here. */
+	PRIVILEGED_DATA static xStaticTaskType xIdleTaskBuffer;
+	PRIVILEGED_DATA static portSTACK_TYPE xIdleTaskStack[ tskIDLE_STACK_SIZE ];
+
+#endif
+
 /* File private variables. --------------------------------*/
 PRIVILEGED_DATA static volatile unsigned portBASE_TYPE uxCurrentNumberOfTasks 	= ( unsigned portBASE_TYPE ) 0;
 PRIVILEGED_DATA static volatile portTickType xTickCount 						= ( portTickType ) 0;
 PRIVILEGED_DATA static unsigned portBASE_TYPE uxTopUsedPriority	 				= tskIDLE_PRIORITY;
-PRIVILEGED_DATA static volatile unsigned portBASE_TYPE uxTopReadyPriority 		= tskIDLE_PRIORITY;
+PRIVILEGED_DATA static volatile unsigned portBASE_TYPE uxTopReadyPriority 		= tskIDLE_PRIORITY;	/*< Highest ready priority, or bitmap of ready priorities (see taskRECORD_READY_PRIORITY). */
 PRIVILEGED_DATA static volatile signed portBASE_TYPE xSchedulerRunning 			= pdFALSE;
 PRIVILEGED_DATA static volatile unsigned portBASE_TYPE uxSchedulerSuspended	 	= ( unsigned portBASE_TYPE ) pdFALSE;
 PRIVILEGED_DATA static volatile unsigned portBASE_TYPE uxMissedTicks 			= ( unsigned portBASE_TYPE ) 0;
@@ -166,7 +191,9 @@ PRIVILEGED_DATA static unsigned portBASE_TYPE uxTaskNumber 						= ( unsigned po
 
 	PRIVILEGED_DATA static char pcStatsString[ 50 ] ;
 	PRIVILEGED_DATA static unsigned long ulTaskSwitchedInTime = 0UL;	/*< Holds the value of a timer/counter the last time a task was switched in. */
+	PRIVILEGED_DATA static volatile unsigned long ulContextSwitches = 0UL;	/*< Number of times a different task has been switched in. */
 	static void prvGenerateRunTimeStatsForTasksInList( const signed char *pcWriteBuffer, xList *pxList, unsigned long ulTotalRunTime ) PRIVILEGED_FUNCTION;
+	static unsigned portBASE_TYPE prvListRunTimeCounters( xTaskRunTimeType *pxCounters, unsigned portBASE_TYPE uxIndex, unsigned portBASE_TYPE uxMaxCounters, xList *pxList, portBASE_TYPE xReset ) PRIVILEGED_FUNCTION;
 
 #endif
 
@@ -178,6 +205,13 @@ PRIVILEGED_DATA static unsigned portBASE_TYPE uxTaskNumber 						= ( unsigned po
  */
 #define tskSTACK_FILL_BYTE	( 0xa5 )
 
+/*
+ * Values of the ucNotifyState member of the TCB.
+ */
+#define taskNOT_WAITING_NOTIFICATION	( ( unsigned char ) 0 )
+#define taskWAITING_NOTIFICATION		( ( unsigned char ) 1 )
+#define taskNOTIFICATION_RECEIVED		( ( unsigned char ) 2 )
+
 /*
  * Macros used by vListTask to indicate which state a task is in.
  */
@@ -240,6 +274,70 @@ PRIVILEGED_DATA static unsigned portBASE_TYPE uxTaskNumber 						= ( unsigned po
 #endif
 /*-----------------------------------------------------------*/
 
+/*
+ * Ready priority bookkeeping.  With the generic method uxTopReadyPriority
+ * holds the highest priority that might have a ready task, and the selection
+ * walks down from there.  With the port optimised method uxTopReadyPriority
+ * is a bitmap with one bit per priority that has ready tasks, and the port
+ * finds the highest set bit in a single instruction (CLZ on the Cortex-M3),
+ * so selecting a task takes the same time whatever configMAX_PRIORITIES is.
+ * The bit of a priority is cleared whenever a task leaves a ready list that
+ * is then empty.
+ */
+#if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 0 )
+
+	#define taskRECORD_READY_PRIORITY( uxPriority )																\
+	{																											\
+		if( ( uxPriority ) > uxTopReadyPriority )																\
+		{																										\
+			uxTopReadyPriority = ( uxPriority );																\
+		}																										\
+	}
+
+	#define taskRESET_READY_PRIORITY( uxPriority )
+
+	#define taskSELECT_HIGHEST_PRIORITY_TASK()																	\
+	{																											\
+		/* Find the highest priority queue that contains ready tasks. */										\
+		while( listLIST_IS_EMPTY( &( pxReadyTasksLists[ uxTopReadyPriority ] ) ) )								\
+		{																										\
+			--uxTopReadyPriority;																				\
+		}																										\
+																												\
+		/* listGET_OWNER_OF_NEXT_ENTRY walks through the list, so the tasks of the								\
+		same priority get an equal share of the processor time. */												\
+		listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopReadyPriority ] ) );				\
+	}
+
+	/* Might a task above the idle priority be ready? */
+	#define taskNON_IDLE_TASK_READY()	( uxTopReadyPriority > tskIDLE_PRIORITY )
+
+#else
+
+	#define taskRECORD_READY_PRIORITY( uxPriority )	portRECORD_READY_PRIORITY( ( uxPriority ), uxTopReadyPriority )
+
+	#define taskRESET_READY_PRIORITY( uxPriority )																\
+	{																											\
+		if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ ( uxPriority ) ] ) ) == ( unsigned portBASE_TYPE ) 0 )	\
+		{																										\
+			portRESET_READY_PRIORITY( ( uxPriority ), uxTopReadyPriority );										\
+		}																										\
+	}
+
+	#define taskSELECT_HIGHEST_PRIORITY_TASK()																	\
+	{																											\
+	unsigned portBASE_TYPE uxTopPriority;																		\
+																												\
+		/* Find the highest priority queue that contains ready tasks. */										\
+		portGET_HIGHEST_PRIORITY( uxTopPriority, uxTopReadyPriority );											\
+		listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopPriority ] ) );					\
+	}
+
+	#define taskNON_IDLE_TASK_READY()	( uxTopReadyPriority > ( 1UL << tskIDLE_PRIORITY ) )
+
+#endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
+/*-----------------------------------------------------------*/
+
 /*
  * Place the task represented by pxTCB into the appropriate ready queue for
  * the task.  It is inserted at the end of the list.  One quirk of this is
@@ -249,10 +347,7 @@ PRIVILEGED_DATA static unsigned portBASE_TYPE uxTaskNumber 						= ( unsigned po
  */
 #define prvAddTaskToReadyQueue( pxTCB )																			\
 {																												\
-	if( pxTCB->uxPriority > uxTopReadyPriority )																\
-	{																											\
-		uxTopReadyPriority = pxTCB->uxPriority;																	\
-	}																											\
+	taskRECORD_READY_PRIORITY( pxTCB->uxPriority );																\
 	vListInsertEnd( ( xList * ) &( pxReadyTasksLists[ pxTCB->uxPriority ] ), &( pxTCB->xGenericListItem ) );	\
 }
 /*-----------------------------------------------------------*/
@@ -309,6 +404,13 @@ static void prvInitialiseTCBVariables( tskTCB *pxTCB, const signed char * const
  */
 static void prvInitialiseTaskLists( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * Moves the calling task from the ready list to the list of suspended tasks
+ * (if xTicksToWait is portMAX_DELAY) or to the appropriate delayed list.  Must
+ * be called with interrupts disabled or the scheduler suspended.
+ */
+static void prvAddCurrentTaskToDelayedList( portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
 /*
  * The idle task, which as all tasks is implemented as a never ending loop.
  * The idle task is automatically created and added to the ready lists upon
@@ -343,10 +445,10 @@ static portTASK_FUNCTION_PROTO( prvIdleTask, pvParameters );
 static void prvCheckTasksWaitingTermination( void ) PRIVILEGED_FUNCTION;
 
 /*
- * Allocates memory from the heap for a TCB and associated stack.  Checks the
- * allocation was successful.
+ * Allocates memory from the heap for a TCB and associated stack, unless both
+ * are supplied by the caller.  Checks the allocation was successful.
  */
-static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer ) PRIVILEGED_FUNCTION;
+static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer, xStaticTaskType *pxTaskBuffer ) PRIVILEGED_FUNCTION;
 
 /*
  * Called from vTaskList.  vListTasks details all the tasks currently under
@@ -374,6 +476,29 @@ static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TY
 
 #endif
 
+/*
+ * Fill in the stack usage of the tasks in pxList, starting at index uxIndex of
+ * pxUsage.  Returns the index following the last element written.
+ */
+#if ( INCLUDE_uxTaskGetStackHighWaterMark == 1 )
+
+	static unsigned portBASE_TYPE prvListStackUsage( xTaskStackUsageType *pxUsage, unsigned portBASE_TYPE uxIndex, unsigned portBASE_TYPE uxMaxUsage, xList *pxList ) PRIVILEGED_FUNCTION;
+
+#endif
+
+/*
+ * Return the number of ticks the idle task can expect to keep the processor,
+ * i.e. the time until the next delayed task has to be unblocked.  Zero is
+ * returned if any other task is ready to run.  The result never reaches past
+ * a tick count overflow, so the tick count can be stepped forward without
+ * having to switch the delayed task lists.
+ */
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+	static portTickType prvGetExpectedIdleTime( void ) PRIVILEGED_FUNCTION;
+
+#endif
+
 
 /*lint +e956 */
 
@@ -383,14 +508,14 @@ static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TY
  * TASK CREATION API documented in task.h
  *----------------------------------------------------------*/
 
-signed portBASE_TYPE xTaskGenericCreate( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, const xMemoryRegion * const xRegions )
+signed portBASE_TYPE xTaskGenericCreate( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, xStaticTaskType *pxTaskBuffer, const xMemoryRegion * const xRegions )
 {
 signed portBASE_TYPE xReturn;
 tskTCB * pxNewTCB;
 
 	/* Allocate the memory required by the TCB and stack for the new task,
 	checking that the allocation was successful. */
-	pxNewTCB = prvAllocateTCBAndStack( usStackDepth, puxStackBuffer );
+	pxNewTCB = prvAllocateTCBAndStack( usStackDepth, puxStackBuffer, pxTaskBuffer );
 
 	if( pxNewTCB != NULL )
 	{
@@ -556,6 +681,7 @@ tskTCB * pxNewTCB;
 			the termination list and free up any memory allocated by the
 			scheduler for the TCB and stack. */
 			vListRemove( &( pxTCB->xGenericListItem ) );
+			taskRESET_READY_PRIORITY( pxTCB->uxPriority );
 
 			/* Is the task waiting on an event also? */
 			if( pxTCB->xEventListItem.pvContainer )
@@ -645,6 +771,7 @@ tskTCB * pxNewTCB;
 				ourselves to the blocked list as the same list item is used for
 				both lists. */
 				vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+				taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
 
 				/* The list item will be inserted in wake time order. */
 				listSET_LIST_ITEM_VALUE( &( pxCurrentTCB->xGenericListItem ), xTimeToWake );
@@ -706,6 +833,7 @@ tskTCB * pxNewTCB;
 				ourselves to the blocked list as the same list item is used for
 				both lists. */
 				vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+				taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
 
 				/* The list item will be inserted in wake time order. */
 				listSET_LIST_ITEM_VALUE( &( pxCurrentTCB->xGenericListItem ), xTimeToWake );
@@ -849,6 +977,7 @@ tskTCB * pxNewTCB;
 					it to it's new ready list.  As we are in a critical section we
 					can do this even if the scheduler is suspended. */
 					vListRemove( &( pxTCB->xGenericListItem ) );
+					taskRESET_READY_PRIORITY( uxCurrentPriority );
 					prvAddTaskToReadyQueue( pxTCB );
 				}
 
@@ -886,6 +1015,7 @@ tskTCB * pxNewTCB;
 
 			/* Remove task from the ready/delayed list and place in the	suspended list. */
 			vListRemove( &( pxTCB->xGenericListItem ) );
+			taskRESET_READY_PRIORITY( pxTCB->uxPriority );
 
 			/* Is the task waiting on an event also? */
 			if( pxTCB->xEventListItem.pvContainer )
@@ -1047,7 +1177,15 @@ void vTaskStartScheduler( void )
 portBASE_TYPE xReturn;
 
 	/* Add the idle task at the lowest priority. */
-	xReturn = xTaskCreate( prvIdleTask, ( signed char * ) "IDLE", tskIDLE_STACK_SIZE, ( void * ) NULL, ( tskIDLE_PRIORITY | portPRIVILEGE_BIT ), ( xTaskHandle * ) NULL );
+	#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+	{
+		xReturn = xTaskCreate( prvIdleTask, ( signed char * ) "IDLE", tskIDLE_STACK_SIZE, ( void * ) NULL, ( tskIDLE_PRIORITY | portPRIVILEGE_BIT ), ( xTaskHandle * ) NULL );
+	}
+	#else
+	{
+		xReturn = xTaskCreateStatic( prvIdleTask, ( signed char * ) "IDLE", tskIDLE_STACK_SIZE, ( void * ) NULL, ( tskIDLE_PRIORITY | portPRIVILEGE_BIT ), ( xTaskHandle * ) NULL, xIdleTaskStack, &xIdleTaskBuffer );
+	}
+	#endif
 
 	if( xReturn == pdPASS )
 	{
@@ -1342,6 +1480,57 @@ unsigned portBASE_TYPE uxTaskGetNumberOfTasks( void )
 #endif
 /*----------------------------------------------------------*/
 
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+
+	unsigned portBASE_TYPE uxTaskGetRunTimeCounters( xTaskRunTimeType *pxCounters, unsigned portBASE_TYPE uxMaxCounters, portBASE_TYPE xReset )
+	{
+	unsigned portBASE_TYPE uxQueue, uxCount = 0;
+
+		/* Unlike vTaskGetRunTimeStats() this only copies the raw counters, so
+		the scheduler is suspended for a short time only. */
+		vTaskSuspendAll();
+		{
+			uxQueue = uxTopUsedPriority + 1;
+
+			do
+			{
+				uxQueue--;
+				uxCount = prvListRunTimeCounters( pxCounters, uxCount, uxMaxCounters, ( xList * ) &( pxReadyTasksLists[ uxQueue ] ), xReset );
+			}while( uxQueue > ( unsigned short ) tskIDLE_PRIORITY );
+
+			uxCount = prvListRunTimeCounters( pxCounters, uxCount, uxMaxCounters, ( xList * ) pxDelayedTaskList, xReset );
+			uxCount = prvListRunTimeCounters( pxCounters, uxCount, uxMaxCounters, ( xList * ) pxOverflowDelayedTaskList, xReset );
+
+			#if ( INCLUDE_vTaskDelete == 1 )
+			{
+				uxCount = prvListRunTimeCounters( pxCounters, uxCount, uxMaxCounters, ( xList * ) &xTasksWaitingTermination, xReset );
+			}
+			#endif
+
+			#if ( INCLUDE_vTaskSuspend == 1 )
+			{
+				uxCount = prvListRunTimeCounters( pxCounters, uxCount, uxMaxCounters, ( xList * ) &xSuspendedTaskList, xReset );
+			}
+			#endif
+		}
+		xTaskResumeAll();
+
+		return uxCount;
+	}
+
+#endif
+/*----------------------------------------------------------*/
+
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+
+	unsigned long ulTaskGetContextSwitchCount( void )
+	{
+		return ulContextSwitches;
+	}
+
+#endif
+/*----------------------------------------------------------*/
+
 #if ( configUSE_TRACE_FACILITY == 1 )
 
 	void vTaskStartTrace( signed char * pcBuffer, unsigned long ulBufferSize )
@@ -1440,6 +1629,43 @@ void vTaskIncrementTick( void )
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+	void vTaskStepTick( portTickType xTicksToJump )
+	{
+		/* The port only sleeps for as long as prvGetExpectedIdleTime() allowed,
+		so no delayed task can be passed over and no overflow can occur. */
+		xTickCount += xTicksToJump;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+	portBASE_TYPE xTaskConfirmSleep( void )
+	{
+	portBASE_TYPE xReturn = pdTRUE;
+
+		/* Called with interrupts disabled.  An interrupt that ran after the
+		idle task decided to sleep may have readied a task (which then waits
+		on the pending ready list, as the scheduler is suspended), or may have
+		counted a tick. */
+		if( listCURRENT_LIST_LENGTH( &xPendingReadyList ) != ( unsigned portBASE_TYPE ) 0 )
+		{
+			xReturn = pdFALSE;
+		}
+		else if( ( xMissedYield != pdFALSE ) || ( uxMissedTicks != ( unsigned portBASE_TYPE ) 0 ) )
+		{
+			xReturn = pdFALSE;
+		}
+
+		return xReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
 #if ( ( INCLUDE_vTaskCleanUpResources == 1 ) && ( INCLUDE_vTaskSuspend == 1 ) )
 
 	void vTaskCleanUpResources( void )
@@ -1582,6 +1808,10 @@ void vTaskIncrementTick( void )
 
 void vTaskSwitchContext( void )
 {
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+	tskTCB *pxPreviousTCB = pxCurrentTCB;
+#endif
+
 	if( uxSchedulerSuspended != ( unsigned portBASE_TYPE ) pdFALSE )
 	{
 		/* The scheduler is currently suspended - do not allow a context
@@ -1609,15 +1839,16 @@ void vTaskSwitchContext( void )
 	taskFIRST_CHECK_FOR_STACK_OVERFLOW();
 	taskSECOND_CHECK_FOR_STACK_OVERFLOW();
 
-	/* Find the highest priority queue that contains ready tasks. */
-	while( listLIST_IS_EMPTY( &( pxReadyTasksLists[ uxTopReadyPriority ] ) ) )
+	taskSELECT_HIGHEST_PRIORITY_TASK();
+
+	#if ( configGENERATE_RUN_TIME_STATS == 1 )
 	{
-		--uxTopReadyPriority;
+		if( pxCurrentTCB != pxPreviousTCB )
+		{
+			ulContextSwitches++;
+		}
 	}
-
-	/* listGET_OWNER_OF_NEXT_ENTRY walks through the list, so the tasks of the
-	same priority get an equal share of the processor time. */
-	listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopReadyPriority ] ) );
+	#endif
 
 	traceTASK_SWITCHED_IN();
 	vWriteTraceToBuffer();
@@ -1626,8 +1857,6 @@ void vTaskSwitchContext( void )
 
 void vTaskPlaceOnEventList( const xList * const pxEventList, portTickType xTicksToWait )
 {
-portTickType xTimeToWake;
-
 	/* THIS FUNCTION MUST BE CALLED WITH INTERRUPTS DISABLED OR THE
 	SCHEDULER SUSPENDED. */
 
@@ -1636,61 +1865,8 @@ portTickType xTimeToWake;
 	is the first to be woken by the event. */
 	vListInsert( ( xList * ) pxEventList, ( xListItem * ) &( pxCurrentTCB->xEventListItem ) );
 
-	/* We must remove ourselves from the ready list before adding ourselves
-	to the blocked list as the same list item is used for both lists.  We have
-	exclusive access to the ready lists as the scheduler is locked. */
-	vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
-
-
-	#if ( INCLUDE_vTaskSuspend == 1 )
-	{
-		if( xTicksToWait == portMAX_DELAY )
-		{
-			/* Add ourselves to the suspended task list instead of a delayed task
-			list to ensure we are not woken by a timing event.  We will block
-			indefinitely. */
-			vListInsertEnd( ( xList * ) &xSuspendedTaskList, ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
-		}
-		else
-		{
-			/* Calculate the time at which the task should be woken if the event does
-			not occur.  This may overflow but this doesn't matter. */
-			xTimeToWake = xTickCount + xTicksToWait;
-
-			listSET_LIST_ITEM_VALUE( &( pxCurrentTCB->xGenericListItem ), xTimeToWake );
-
-			if( xTimeToWake < xTickCount )
-			{
-				/* Wake time has overflowed.  Place this item in the overflow list. */
-				vListInsert( ( xList * ) pxOverflowDelayedTaskList, ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
-			}
-			else
-			{
-				/* The wake time has not overflowed, so we can use the current block list. */
-				vListInsert( ( xList * ) pxDelayedTaskList, ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
-			}
-		}
-	}
-	#else
-	{
-			/* Calculate the time at which the task should be woken if the event does
-			not occur.  This may overflow but this doesn't matter. */
-			xTimeToWake = xTickCount + xTicksToWait;
-
-			listSET_LIST_ITEM_VALUE( &( pxCurrentTCB->xGenericListItem ), xTimeToWake );
-
-			if( xTimeToWake < xTickCount )
-			{
-				/* Wake time has overflowed.  Place this item in the overflow list. */
-				vListInsert( ( xList * ) pxOverflowDelayedTaskList, ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
-			}
-			else
-			{
-				/* The wake time has not overflowed, so we can use the current block list. */
-				vListInsert( ( xList * ) pxDelayedTaskList, ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
-			}
-	}
-	#endif
+	/* Move the task from the ready list to a blocked list. */
+	prvAddCurrentTaskToDelayedList( xTicksToWait );
 }
 /*-----------------------------------------------------------*/
 
@@ -1857,6 +2033,32 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 			vApplicationIdleHook();
 		}
 		#endif
+
+		#if ( configUSE_TICKLESS_IDLE == 1 )
+		{
+		portTickType xExpectedIdleTime;
+
+			/* Only stop the tick if no other task will run for a while.  The
+			expected idle time is computed again with the scheduler suspended,
+			as a task might have been unblocked in the meantime; the scheduler
+			stays suspended until the tick count has been corrected. */
+			xExpectedIdleTime = prvGetExpectedIdleTime();
+
+			if( xExpectedIdleTime >= configEXPECTED_IDLE_TIME_BEFORE_SLEEP )
+			{
+				vTaskSuspendAll();
+				{
+					xExpectedIdleTime = prvGetExpectedIdleTime();
+
+					if( xExpectedIdleTime >= configEXPECTED_IDLE_TIME_BEFORE_SLEEP )
+					{
+						portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime );
+					}
+				}
+				xTaskResumeAll();
+			}
+		}
+		#endif
 	}
 } /*lint !e715 pvParameters is not accessed but all task functions require the same prototype. */
 
@@ -1897,6 +2099,19 @@ static void prvInitialiseTCBVariables( tskTCB *pxTCB, const signed char * const
 	}
 	#endif
 
+	#if ( INCLUDE_uxTaskGetStackHighWaterMark == 1 )
+	{
+		pxTCB->usStackDepth = usStackDepth;
+	}
+	#endif
+
+	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+	{
+		pxTCB->ulNotifiedValue = 0UL;
+		pxTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+	}
+	#endif
+
 	vListInitialiseItem( &( pxTCB->xGenericListItem ) );
 	vListInitialiseItem( &( pxTCB->xEventListItem ) );
 
@@ -1990,68 +2205,158 @@ unsigned portBASE_TYPE uxPriority;
 }
 /*-----------------------------------------------------------*/
 
-static void prvCheckTasksWaitingTermination( void )
+static void prvAddCurrentTaskToDelayedList( portTickType xTicksToWait )
 {
-	#if ( INCLUDE_vTaskDelete == 1 )
-	{
-		portBASE_TYPE xListIsEmpty;
-
-		/* ucTasksDeleted is used to prevent vTaskSuspendAll() being called
-		too often in the idle task. */
-		if( uxTasksDeleted > ( unsigned portBASE_TYPE ) 0 )
-		{
-			vTaskSuspendAll();
-				xListIsEmpty = listLIST_IS_EMPTY( &xTasksWaitingTermination );
-			xTaskResumeAll();
-
-			if( !xListIsEmpty )
-			{
-				tskTCB *pxTCB;
-
-				portENTER_CRITICAL();
-				{
-					pxTCB = ( tskTCB * ) listGET_OWNER_OF_HEAD_ENTRY( ( ( xList * ) &xTasksWaitingTermination ) );
-					vListRemove( &( pxTCB->xGenericListItem ) );
-					--uxCurrentNumberOfTasks;
-					--uxTasksDeleted;
-				}
-				portEXIT_CRITICAL();
-
-				prvDeleteTCB( pxTCB );
-			}
-		}
-	}
-	#endif
-}
-/*-----------------------------------------------------------*/
+portTickType xTimeToWake;
 
-static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer )
-{
-tskTCB *pxNewTCB;
+	/* We must remove ourselves from the ready list before adding ourselves
+	to the blocked list as the same list item is used for both lists.  We have
+	exclusive access to the ready lists as the scheduler is locked. */
+	vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+	taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
 
-	/* Allocate space for the TCB.  Where the memory comes from depends on
-	the implementation of the port malloc function. */
-	pxNewTCB = ( tskTCB * ) pvPortMalloc( sizeof( tskTCB ) );
 
-	if( pxNewTCB != NULL )
+	#if ( INCLUDE_vTaskSuspend == 1 )
 	{
-		/* Allocate space for the stack used by the task being created.
-		The base of the stack memory stored in the TCB so the task can
-		be deleted later if required. */
-		pxNewTCB->pxStack = ( portSTACK_TYPE * ) pvPortMallocAligned( ( ( ( size_t )usStackDepth ) * sizeof( portSTACK_TYPE ) ), puxStackBuffer );
-
-		if( pxNewTCB->pxStack == NULL )
+		if( xTicksToWait == portMAX_DELAY )
 		{
-			/* Could not allocate the stack.  Delete the allocated TCB. */
-			vPortFree( pxNewTCB );
-			pxNewTCB = NULL;
+			/* Add ourselves to the suspended task list instead of a delayed task
+			list to ensure we are not woken by a timing event.  We will block
+			indefinitely. */
+			vListInsertEnd( ( xList * ) &xSuspendedTaskList, ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
 		}
 		else
 		{
-			/* Just to help debugging. */
-			memset( pxNewTCB->pxStack, tskSTACK_FILL_BYTE, usStackDepth * sizeof( portSTACK_TYPE ) );
+			/* Calculate the time at which the task should be woken if the event does
+			not occur.  This may overflow but this doesn't matter. */
+			xTimeToWake = xTickCount + xTicksToWait;
+
+			listSET_LIST_ITEM_VALUE( &( pxCurrentTCB->xGenericListItem ), xTimeToWake );
+
+			if( xTimeToWake < xTickCount )
+			{
+				/* Wake time has overflowed.  Place this item in the overflow list. */
+				vListInsert( ( xList * ) pxOverflowDelayedTaskList, ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+			}
+			else
+			{
+				/* The wake time has not overflowed, so we can use the current block list. */
+				vListInsert( ( xList * ) pxDelayedTaskList, ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+			}
 		}
 	}
+	#else
+	{
+			/* Calculate the time at which the task should be woken if the event does
+			not occur.  This may overflow but this doesn't matter. */
+			xTimeToWake = xTickCount + xTicksToWait;
+
+			listSET_LIST_ITEM_VALUE( &( pxCurrentTCB->xGenericListItem ), xTimeToWake );
+
+			if( xTimeToWake < xTickCount )
+			{
+				/* Wake time has overflowed.  Place this item in the overflow list. */
+				vListInsert( ( xList * ) pxOverflowDelayedTaskList, ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+			}
+			else
+			{
+				/* The wake time has not overflowed, so we can use the current block list. */
+				vListInsert( ( xList * ) pxDelayedTaskList, ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+			}
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvCheckTasksWaitingTermination( void )
+{
+	#if ( INCLUDE_vTaskDelete == 1 )
+	{
+		portBASE_TYPE xListIsEmpty;
+
+		/* ucTasksDeleted is used to prevent vTaskSuspendAll() being called
+		too often in the idle task. */
+		if( uxTasksDeleted > ( unsigned portBASE_TYPE ) 0 )
+		{
+			vTaskSuspendAll();
+				xListIsEmpty = listLIST_IS_EMPTY( &xTasksWaitingTermination );
+			xTaskResumeAll();
+
+			if( !xListIsEmpty )
+			{
+				tskTCB *pxTCB;
+
+				portENTER_CRITICAL();
+				{
+					pxTCB = ( tskTCB * ) listGET_OWNER_OF_HEAD_ENTRY( ( ( xList * ) &xTasksWaitingTermination ) );
+					vListRemove( &( pxTCB->xGenericListItem ) );
+					--uxCurrentNumberOfTasks;
+					--uxTasksDeleted;
+				}
+				portEXIT_CRITICAL();
+
+				prvDeleteTCB( pxTCB );
+			}
+		}
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer, xStaticTaskType *pxTaskBuffer )
+{
+tskTCB *pxNewTCB = NULL;
+
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	{
+		if( ( pxTaskBuffer != NULL ) && ( puxStackBuffer != NULL ) )
+		{
+			/* The caller supplied the memory for both the TCB and the stack,
+			nothing needs to be allocated. */
+			pxNewTCB = ( tskTCB * ) pxTaskBuffer;
+			pxNewTCB->pxStack = puxStackBuffer;
+		}
+	}
+	#endif
+
+	#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+	{
+		if( pxTaskBuffer == NULL )
+		{
+			/* Allocate space for the TCB.  Where the memory comes from depends on
+			the implementation of the port malloc function. */
+			pxNewTCB = ( tskTCB * ) pvPortMalloc( sizeof( tskTCB ) );
+
+			if( pxNewTCB != NULL )
+			{
+				/* Allocate space for the stack used by the task being created.
+				The base of the stack memory stored in the TCB so the task can
+				be deleted later if required. */
+				pxNewTCB->pxStack = ( portSTACK_TYPE * ) pvPortMallocAligned( ( ( ( size_t )usStackDepth ) * sizeof( portSTACK_TYPE ) ), puxStackBuffer );
+
+				if( pxNewTCB->pxStack == NULL )
+				{
+					/* Could not allocate the stack.  Delete the allocated TCB. */
+					vPortFree( pxNewTCB );
+					pxNewTCB = NULL;
+				}
+			}
+		}
+	}
+	#endif
+
+	if( pxNewTCB != NULL )
+	{
+		#if ( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+		{
+			/* Remember where the memory came from, for prvDeleteTCB(). */
+			pxNewTCB->ucStaticallyAllocated = ( unsigned char ) ( ( pxTaskBuffer != NULL ) ? pdTRUE : pdFALSE );
+		}
+		#endif
+
+		/* Just to help debugging. */
+		memset( pxNewTCB->pxStack, tskSTACK_FILL_BYTE, usStackDepth * sizeof( portSTACK_TYPE ) );
+	}
 
 	return pxNewTCB;
 }
@@ -2138,6 +2443,44 @@ tskTCB *pxNewTCB;
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+
+	static unsigned portBASE_TYPE prvListRunTimeCounters( xTaskRunTimeType *pxCounters, unsigned portBASE_TYPE uxIndex, unsigned portBASE_TYPE uxMaxCounters, xList *pxList, portBASE_TYPE xReset )
+	{
+	volatile tskTCB *pxNextTCB, *pxFirstTCB;
+
+		if( listLIST_IS_EMPTY( pxList ) )
+		{
+			return uxIndex;
+		}
+
+		/* Copy the counters of all the TCB's in pxList, as long as there is
+		room left in the array. */
+		listGET_OWNER_OF_NEXT_ENTRY( pxFirstTCB, pxList );
+		do
+		{
+			listGET_OWNER_OF_NEXT_ENTRY( pxNextTCB, pxList );
+
+			if( uxIndex < uxMaxCounters )
+			{
+				pxCounters[ uxIndex ].pcTaskName = ( const signed char * ) pxNextTCB->pcTaskName;
+				pxCounters[ uxIndex ].ulRunTimeCounter = pxNextTCB->ulRunTimeCounter;
+				uxIndex++;
+
+				if( xReset != pdFALSE )
+				{
+					pxNextTCB->ulRunTimeCounter = 0UL;
+				}
+			}
+
+		} while( pxNextTCB != pxFirstTCB );
+
+		return uxIndex;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
 #if ( ( configUSE_TRACE_FACILITY == 1 ) || ( INCLUDE_uxTaskGetStackHighWaterMark == 1 ) )
 
 	static unsigned short usTaskCheckFreeStackSpace( const unsigned char * pucStackByte )
@@ -2158,6 +2501,44 @@ tskTCB *pxNewTCB;
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+	static portTickType prvGetExpectedIdleTime( void )
+	{
+	portTickType xReturn;
+
+		if( taskNON_IDLE_TASK_READY() )
+		{
+			xReturn = 0;
+		}
+		else if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ tskIDLE_PRIORITY ] ) ) > ( unsigned portBASE_TYPE ) 1 )
+		{
+			/* Another task shares the idle priority and is ready to run. */
+			xReturn = 0;
+		}
+		else if( uxMissedTicks != ( unsigned portBASE_TYPE ) 0 )
+		{
+			/* The tick count is behind, leave it to xTaskResumeAll(). */
+			xReturn = 0;
+		}
+		else if( listLIST_IS_EMPTY( pxDelayedTaskList ) == pdFALSE )
+		{
+			xReturn = listGET_LIST_ITEM_VALUE( ( pxDelayedTaskList->xListEnd ).pxNext ) - xTickCount;
+		}
+		else
+		{
+			/* Nothing to wake before the tick count overflows.  The overflow
+			itself has to be handled by a real tick, as it swaps the delayed
+			task lists. */
+			xReturn = portMAX_DELAY - xTickCount;
+		}
+
+		return xReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
 #if ( INCLUDE_uxTaskGetStackHighWaterMark == 1 )
 
 	unsigned portBASE_TYPE uxTaskGetStackHighWaterMark( xTaskHandle xTask )
@@ -2186,14 +2567,107 @@ tskTCB *pxNewTCB;
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( INCLUDE_uxTaskGetStackHighWaterMark == 1 )
+
+	unsigned portBASE_TYPE uxTaskGetStackUsage( xTaskStackUsageType *pxUsage, unsigned portBASE_TYPE uxMaxUsage )
+	{
+	unsigned portBASE_TYPE uxQueue, uxCount = 0;
+
+		/* Each stack is scanned from its end up to the first byte that does
+		not hold the fill value any more, so the scheduler is suspended for a
+		time proportional to the unused stack space of all tasks.  Interrupts
+		remain enabled. */
+		vTaskSuspendAll();
+		{
+			uxQueue = uxTopUsedPriority + 1;
+
+			do
+			{
+				uxQueue--;
+				uxCount = prvListStackUsage( pxUsage, uxCount, uxMaxUsage, ( xList * ) &( pxReadyTasksLists[ uxQueue ] ) );
+			}while( uxQueue > ( unsigned short ) tskIDLE_PRIORITY );
+
+			uxCount = prvListStackUsage( pxUsage, uxCount, uxMaxUsage, ( xList * ) pxDelayedTaskList );
+			uxCount = prvListStackUsage( pxUsage, uxCount, uxMaxUsage, ( xList * ) pxOverflowDelayedTaskList );
+
+			#if ( INCLUDE_vTaskSuspend == 1 )
+			{
+				uxCount = prvListStackUsage( pxUsage, uxCount, uxMaxUsage, ( xList * ) &xSuspendedTaskList );
+			}
+			#endif
+		}
+		xTaskResumeAll();
+
+		return uxCount;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( INCLUDE_uxTaskGetStackHighWaterMark == 1 )
+
+	static unsigned portBASE_TYPE prvListStackUsage( xTaskStackUsageType *pxUsage, unsigned portBASE_TYPE uxIndex, unsigned portBASE_TYPE uxMaxUsage, xList *pxList )
+	{
+	volatile tskTCB *pxNextTCB, *pxFirstTCB;
+
+		if( listLIST_IS_EMPTY( pxList ) )
+		{
+			return uxIndex;
+		}
+
+		listGET_OWNER_OF_NEXT_ENTRY( pxFirstTCB, pxList );
+		do
+		{
+			listGET_OWNER_OF_NEXT_ENTRY( pxNextTCB, pxList );
+
+			if( uxIndex < uxMaxUsage )
+			{
+				pxUsage[ uxIndex ].pcTaskName = ( const signed char * ) pxNextTCB->pcTaskName;
+				pxUsage[ uxIndex ].usStackDepth = pxNextTCB->usStackDepth;
+
+				#if portSTACK_GROWTH < 0
+				{
+					pxUsage[ uxIndex ].usHighWaterMark = usTaskCheckFreeStackSpace( ( unsigned char * ) pxNextTCB->pxStack );
+				}
+				#else
+				{
+					pxUsage[ uxIndex ].usHighWaterMark = usTaskCheckFreeStackSpace( ( unsigned char * ) pxNextTCB->pxEndOfStack );
+				}
+				#endif
+
+				uxIndex++;
+			}
+
+		} while( pxNextTCB != pxFirstTCB );
+
+		return uxIndex;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
 #if ( ( INCLUDE_vTaskDelete == 1 ) || ( INCLUDE_vTaskCleanUpResources == 1 ) )
 
 	static void prvDeleteTCB( tskTCB *pxTCB )
 	{
 		/* Free up the memory allocated by the scheduler for the task.  It is up to
 		the task to free any memory allocated at the application level. */
-		vPortFreeAligned( pxTCB->pxStack );
-		vPortFree( pxTCB );
+		#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+		{
+			#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+				if( pxTCB->ucStaticallyAllocated == ( unsigned char ) pdFALSE )
+			#endif
+			{
+				vPortFreeAligned( pxTCB->pxStack );
+				vPortFree( pxTCB );
+			}
+		}
+		#else
+		{
+			/* The TCB and the stack belong to the application. */
+			( void ) pxTCB;
+		}
+		#endif
 	}
 
 #endif
@@ -2263,6 +2737,7 @@ tskTCB *pxNewTCB;
 			if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxTCB->uxPriority ] ), &( pxTCB->xGenericListItem ) ) )
 			{
 				vListRemove( &( pxTCB->xGenericListItem ) );
+				taskRESET_READY_PRIORITY( pxTCB->uxPriority );
 
 				/* Inherit the priority before being moved into the new list. */
 				pxTCB->uxPriority = pxCurrentTCB->uxPriority;
@@ -2292,6 +2767,7 @@ tskTCB *pxNewTCB;
 				/* We must be the running task to be able to give the mutex back.
 				Remove ourselves from the ready list we currently appear in. */
 				vListRemove( &( pxTCB->xGenericListItem ) );
+				taskRESET_READY_PRIORITY( pxTCB->uxPriority );
 
 				/* Disinherit the priority before adding ourselves into the new
 				ready list. */
@@ -2341,6 +2817,261 @@ void vTaskExitCritical( void )
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
 
+	portBASE_TYPE xTaskNotifyWait( unsigned long ulBitsToClearOnEntry, unsigned long ulBitsToClearOnExit, unsigned long *pulNotificationValue, portTickType xTicksToWait )
+	{
+	portBASE_TYPE xReturn;
 
+		taskENTER_CRITICAL();
+		{
+			/* Only block if a notification is not already pending. */
+			if( pxCurrentTCB->ucNotifyState != taskNOTIFICATION_RECEIVED )
+			{
+				/* Clear bits in the task's notification value as bits may get
+				set by the notifying task or interrupt.  This can be used to
+				clear the value to zero. */
+				pxCurrentTCB->ulNotifiedValue &= ~ulBitsToClearOnEntry;
+
+				pxCurrentTCB->ucNotifyState = taskWAITING_NOTIFICATION;
+
+				if( xTicksToWait > ( portTickType ) 0 )
+				{
+					/* The task is not placed on any event list - the notifying
+					task or interrupt moves it straight back to the ready list. */
+					prvAddCurrentTaskToDelayedList( xTicksToWait );
+					portYIELD_WITHIN_API();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		taskENTER_CRITICAL();
+		{
+			if( pulNotificationValue != NULL )
+			{
+				/* Output the current notification value, which may or may not
+				have changed. */
+				*pulNotificationValue = pxCurrentTCB->ulNotifiedValue;
+			}
+
+			/* If ucNotifyState is still taskWAITING_NOTIFICATION then the task
+			either did not wait or timed out without being notified. */
+			if( pxCurrentTCB->ucNotifyState == taskWAITING_NOTIFICATION )
+			{
+				xReturn = pdFALSE;
+			}
+			else
+			{
+				/* A notification was already pending or a notification was
+				received while the task was waiting. */
+				pxCurrentTCB->ulNotifiedValue &= ~ulBitsToClearOnExit;
+				xReturn = pdTRUE;
+			}
+
+			pxCurrentTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait )
+	{
+	unsigned long ulReturn;
+
+		taskENTER_CRITICAL();
+		{
+			/* Only block if the notification count is not already non-zero. */
+			if( pxCurrentTCB->ulNotifiedValue == 0UL )
+			{
+				pxCurrentTCB->ucNotifyState = taskWAITING_NOTIFICATION;
+
+				if( xTicksToWait > ( portTickType ) 0 )
+				{
+					prvAddCurrentTaskToDelayedList( xTicksToWait );
+					portYIELD_WITHIN_API();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		taskENTER_CRITICAL();
+		{
+			ulReturn = pxCurrentTCB->ulNotifiedValue;
+
+			if( ulReturn != 0UL )
+			{
+				if( xClearCountOnExit != pdFALSE )
+				{
+					pxCurrentTCB->ulNotifiedValue = 0UL;
+				}
+				else
+				{
+					pxCurrentTCB->ulNotifiedValue = ulReturn - 1UL;
+				}
+			}
+
+			pxCurrentTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+		}
+		taskEXIT_CRITICAL();
+
+		return ulReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	static portBASE_TYPE prvUpdateNotifiedValue( tskTCB *pxTCB, unsigned long ulValue, eNotifyAction eAction, unsigned char ucOriginalNotifyState )
+	{
+	portBASE_TYPE xReturn = pdPASS;
+
+		/* Must be called with interrupts masked. */
+		switch( eAction )
+		{
+			case eSetBits :
+				pxTCB->ulNotifiedValue |= ulValue;
+				break;
+
+			case eIncrement :
+				( pxTCB->ulNotifiedValue )++;
+				break;
+
+			case eSetValueWithOverwrite :
+				pxTCB->ulNotifiedValue = ulValue;
+				break;
+
+			case eSetValueWithoutOverwrite :
+				if( ucOriginalNotifyState != taskNOTIFICATION_RECEIVED )
+				{
+					pxTCB->ulNotifiedValue = ulValue;
+				}
+				else
+				{
+					/* The value could not be written to the task. */
+					xReturn = pdFAIL;
+				}
+				break;
+
+			case eNoAction :
+			default :
+				/* The task is being notified without its notify value being
+				updated. */
+				break;
+		}
+
+		return xReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	portBASE_TYPE xTaskGenericNotify( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, unsigned long *pulPreviousNotificationValue )
+	{
+	tskTCB *pxTCB;
+	unsigned char ucOriginalNotifyState;
+	portBASE_TYPE xReturn;
+
+		pxTCB = ( tskTCB * ) xTaskToNotify;
+
+		taskENTER_CRITICAL();
+		{
+			if( pulPreviousNotificationValue != NULL )
+			{
+				*pulPreviousNotificationValue = pxTCB->ulNotifiedValue;
+			}
+
+			ucOriginalNotifyState = pxTCB->ucNotifyState;
+			pxTCB->ucNotifyState = taskNOTIFICATION_RECEIVED;
+
+			xReturn = prvUpdateNotifiedValue( pxTCB, ulValue, eAction, ucOriginalNotifyState );
+
+			/* If the task is blocked waiting for a notification then unblock
+			it now.  It is not on an event list so only its generic list item
+			has to be moved. */
+			if( ucOriginalNotifyState == taskWAITING_NOTIFICATION )
+			{
+				vListRemove( &( pxTCB->xGenericListItem ) );
+				prvAddTaskToReadyQueue( pxTCB );
+
+				if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+				{
+					/* The notified task has a priority above the currently
+					executing task so a yield is required. */
+					portYIELD_WITHIN_API();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	portBASE_TYPE xTaskGenericNotifyFromISR( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, unsigned long *pulPreviousNotificationValue, signed portBASE_TYPE *pxHigherPriorityTaskWoken )
+	{
+	tskTCB *pxTCB;
+	unsigned char ucOriginalNotifyState;
+	portBASE_TYPE xReturn;
+	unsigned portBASE_TYPE uxSavedInterruptStatus;
+
+		pxTCB = ( tskTCB * ) xTaskToNotify;
+
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			if( pulPreviousNotificationValue != NULL )
+			{
+				*pulPreviousNotificationValue = pxTCB->ulNotifiedValue;
+			}
+
+			ucOriginalNotifyState = pxTCB->ucNotifyState;
+			pxTCB->ucNotifyState = taskNOTIFICATION_RECEIVED;
+
+			xReturn = prvUpdateNotifiedValue( pxTCB, ulValue, eAction, ucOriginalNotifyState );
+
+			/* A waiting task is unblocked only once - a second notification
+			before it runs finds it already in the ready or pending list. */
+			if( ( ucOriginalNotifyState == taskWAITING_NOTIFICATION ) &&
+				( listIS_CONTAINED_WITHIN( &xPendingReadyList, &( pxTCB->xEventListItem ) ) == pdFALSE ) )
+			{
+				if( uxSchedulerSuspended == ( unsigned portBASE_TYPE ) pdFALSE )
+				{
+					vListRemove( &( pxTCB->xGenericListItem ) );
+					prvAddTaskToReadyQueue( pxTCB );
+				}
+				else
+				{
+					/* The delayed and ready lists cannot be accessed, so hold
+					this task pending until the scheduler is resumed. */
+					vListInsertEnd( ( xList * ) &( xPendingReadyList ), &( pxTCB->xEventListItem ) );
+				}
+
+				if( ( pxTCB->uxPriority > pxCurrentTCB->uxPriority ) && ( pxHigherPriorityTaskWoken != NULL ) )
+				{
+					/* The notified task has a priority above the currently
+					executing task so a context switch is required. */
+					*pxHigherPriorityTaskWoken = pdTRUE;
+				}
+			}
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+		return xReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
 
@@ -79,12 +79,48 @@
 #define configUSE_16_BIT_TICKS		0
 #define configIDLE_SHOULD_YIELD		1
 
+/* Keep the ready priorities in a bitmap and select the next task with CLZ,
+which takes constant time whatever configMAX_PRIORITIES is. */
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION	1
+
+/* Stop the tick and sleep in WFI when the idle task expects to run for at
+least configEXPECTED_IDLE_TIME_BEFORE_SLEEP ticks. */
+#define configUSE_TICKLESS_IDLE		1
+#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP	2
+
+/* Accumulate the execution time of each task in CPU cycles, counted by the
+DWT cycle counter (see cpu_usage.c).  The counter wraps around after about
+59 s at 72 MHz. */
+#define configGENERATE_RUN_TIME_STATS	1
+extern void vConfigureTimerForRunTimeStats( void );
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()	vConfigureTimerForRunTimeStats()
+#define portGET_RUN_TIME_COUNTER_VALUE()	( *( ( volatile unsigned long * ) 0xe0001004 ) )
+
+/* Check for stack overflows at every context switch, by the stack pointer
+and by the fill pattern at the end of the stack (see StackMacros.h).  The
+hook is vApplicationStackOverflowHook() in stack_monitor.c. */
+#define configCHECK_FOR_STACK_OVERFLOW	2
+
+/* All tasks, queues and mutexes are created in memory reserved statically by
+the application (xTaskCreateStatic(), xQueueCreateStatic() and
+xSemaphoreCreateMutexStatic()), so the RAM used is known at link time and
+the heap is left out.  The host benchmark of the heap (bench/heap_bench.c)
+sets configSUPPORT_DYNAMIC_ALLOCATION to 1 on the command line. */
+#define configSUPPORT_STATIC_ALLOCATION	1
+#ifndef configSUPPORT_DYNAMIC_ALLOCATION
+	#define configSUPPORT_DYNAMIC_ALLOCATION	0
+#endif
+
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES 		0
 #define configMAX_CO_ROUTINE_PRIORITIES ( 2 )
 
 #define configUSE_MUTEXES           1
 
+/* Direct-to-task notifications (xTaskNotify(), ulTaskNotifyTake()), used
+instead of a binary semaphore where an interrupt only wakes up one task. */
+#define configUSE_TASK_NOTIFICATIONS	1
+
 /* Set the following definitions to 1 to include the API function, or zero
 to exclude the API function. */
 
@@ -95,6 +131,7 @@ to exclude the API function. */
 #define INCLUDE_vTaskSuspend			1
 #define INCLUDE_vTaskDelayUntil			1
 #define INCLUDE_vTaskDelay				1
+#define INCLUDE_uxTaskGetStackHighWaterMark	1
 
 /* This is the raw value as per the Cortex-M3 NVIC.  Values can be 255
 (lowest) to 0 (1?) (highest). */
@@ -0,0 +1,497 @@
+/**
+ * Program skeleton for the course "Programming embedded systems"
+ *
+ * Lab 1: the elevator control system
+ */
+
+/**
+ * Exhaustive host check of the debounce tables (pin_listener.h).
+ *
+ * pin_listener.c is included, so that the unmodified samplePort()
+ * processes the samples of a single pin. Every input sequence up to
+ * the given length, from both stable levels, is fed to
+ *
+ *   DEBOUNCE_TABLE(2, 3)  and compared with the state machine that
+ *                         debounced the buttons before the tables
+ *                         (stop button and call buttons)
+ *   DEBOUNCE_TABLE(0, 0)  and compared with plain edge detection,
+ *                         as the sensors were handled before
+ *   DEBOUNCE_TABLE(N, W)  for all 0 <= N <= W <= DEBOUNCE_MAX_WINDOW,
+ *                         and compared with the definition: an edge is
+ *                         accepted at the first sample at which N
+ *                         consecutive differing samples have followed
+ *                         the one that started it, and env4 is violated
+ *                         as soon as no continuation of the input can
+ *                         achieve that within W samples
+ *
+ * The events (with their tick) and the env4 flag are compared after
+ * every sample. The program exits with status 1 on the first mismatch.
+ *
+ * Build and run on the host (from this directory):
+ *
+ *   gcc -O2 -I.. -I../FreeRTOS/inc -I../STM32F10xFWLib/inc \
+ *       -o debounce_check debounce_check.c
+ *
+ *   ./debounce_check [length]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../pin_listener.c"
+
+#define MAX_LENGTH   20
+#define MAX_EVENTS   (MAX_LENGTH + 1)
+
+#define PIN          GPIO_Pin_0
+
+typedef struct {
+  PinEvent event[MAX_EVENTS];
+  portTickType tick[MAX_EVENTS];
+  int num;
+  bool unstable;
+} Trace;
+
+// all events published by samplePort, through the queue stub
+static Trace *published;
+
+/*-----------------------------------------------------------*/
+/* Peripherals and kernel services referenced by pin_listener.c */
+
+void GPIO_Init(GPIO_TypeDef* GPIOx, GPIO_InitTypeDef* GPIO_InitStruct) {
+}
+
+u16 GPIO_ReadInputData(GPIO_TypeDef* GPIOx) {
+  return 0;
+}
+
+void GPIO_EXTILineConfig(u8 GPIO_PortSource, u8 GPIO_PinSource) {
+}
+
+void EXTI_Init(EXTI_InitTypeDef* EXTI_InitStruct) {
+}
+
+void EXTI_ClearITPendingBit(u32 EXTI_Line) {
+}
+
+void NVIC_Init(NVIC_InitTypeDef* NVIC_InitStruct) {
+}
+
+void RCC_AHBPeriphClockCmd(u32 RCC_AHBPeriph, FunctionalState NewState) {
+}
+
+void RCC_APB1PeriphClockCmd(u32 RCC_APB1Periph, FunctionalState NewState) {
+}
+
+void TIM_DeInit(TIM_TypeDef* TIMx) {
+}
+
+void TIM_TimeBaseStructInit(TIM_TimeBaseInitTypeDef* TIM_TimeBaseInitStruct) {
+}
+
+void TIM_TimeBaseInit(TIM_TypeDef* TIMx,
+                      TIM_TimeBaseInitTypeDef* TIM_TimeBaseInitStruct) {
+}
+
+void TIM_DMACmd(TIM_TypeDef* TIMx, u16 TIM_DMASource,
+                FunctionalState NewState) {
+}
+
+void TIM_Cmd(TIM_TypeDef* TIMx, FunctionalState NewState) {
+}
+
+void DMA_DeInit(DMA_Channel_TypeDef* DMA_Channelx) {
+}
+
+void DMA_Init(DMA_Channel_TypeDef* DMA_Channelx,
+              DMA_InitTypeDef* DMA_InitStruct) {
+}
+
+void DMA_Cmd(DMA_Channel_TypeDef* DMA_Channelx, FunctionalState NewState) {
+}
+
+u16 DMA_GetCurrDataCounter(DMA_Channel_TypeDef* DMA_Channelx) {
+  return PIN_SAMPLE_BUFFER;
+}
+
+signed portBASE_TYPE xQueueGenericSend(xQueueHandle xQueue,
+                                       const void * const pvItemToQueue,
+                                       portTickType xTicksToWait,
+                                       portBASE_TYPE xCopyPosition) {
+  const TimedPinEvent *ev = (const TimedPinEvent*)pvItemToQueue;
+
+  published->event[published->num] = ev->event;
+  published->tick[published->num] = ev->tick;
+  published->num++;
+  return pdTRUE;
+}
+
+signed portBASE_TYPE xTaskGenericCreate(pdTASK_CODE pvTaskCode,
+                                        const signed char * const pcName,
+                                        unsigned short usStackDepth,
+                                        void *pvParameters,
+                                        unsigned portBASE_TYPE uxPriority,
+                                        xTaskHandle *pxCreatedTask,
+                                        portSTACK_TYPE *puxStackBuffer,
+                                        xStaticTaskType *pxTaskBuffer,
+                                        const xMemoryRegion * const xRegions) {
+  return pdTRUE;
+}
+
+portTickType xTaskGetTickCount(void) {
+  return 0;
+}
+
+void vTaskDelayUntil(portTickType * const pxPreviousWakeTime,
+                     portTickType xTimeIncrement) {
+}
+
+unsigned long ulTaskNotifyTake(portBASE_TYPE xClearCountOnExit,
+                               portTickType xTicksToWait) {
+  return 0;
+}
+
+portBASE_TYPE xTaskGenericNotifyFromISR(xTaskHandle xTaskToNotify,
+                                        unsigned long ulValue,
+                                        eNotifyAction eAction,
+                                        unsigned long *pulPreviousNotificationValue,
+                                        signed portBASE_TYPE *pxHigherPriorityTaskWoken) {
+  return pdPASS;
+}
+
+void vPortYieldFromISR(void) {
+}
+
+void assert_failed(u8* file, u32 line) {
+  fprintf(stderr, "assertion failed: %s:%lu\n", (char*)file, (unsigned long)line);
+  exit(1);
+}
+
+/*-----------------------------------------------------------*/
+/* Tables under test */
+
+typedef struct {
+  u8 length, window;
+  DebounceTable *table;
+} Config;
+
+#define CONFIG(N, W) \
+  static DebounceTable table##N##W = DEBOUNCE_TABLE(N, W)
+
+CONFIG(0, 0);
+CONFIG(0, 1); CONFIG(1, 1);
+CONFIG(0, 2); CONFIG(1, 2); CONFIG(2, 2);
+CONFIG(0, 3); CONFIG(1, 3); CONFIG(2, 3); CONFIG(3, 3);
+CONFIG(0, 4); CONFIG(1, 4); CONFIG(2, 4); CONFIG(3, 4); CONFIG(4, 4);
+CONFIG(0, 5); CONFIG(1, 5); CONFIG(2, 5); CONFIG(3, 5); CONFIG(4, 5);
+CONFIG(5, 5);
+CONFIG(0, 6); CONFIG(1, 6); CONFIG(2, 6); CONFIG(3, 6); CONFIG(4, 6);
+CONFIG(5, 6); CONFIG(6, 6);
+
+#define ENTRY(N, W) { N, W, &table##N##W }
+
+static const Config configs[] = {
+  ENTRY(0, 0),
+  ENTRY(0, 1), ENTRY(1, 1),
+  ENTRY(0, 2), ENTRY(1, 2), ENTRY(2, 2),
+  ENTRY(0, 3), ENTRY(1, 3), ENTRY(2, 3), ENTRY(3, 3),
+  ENTRY(0, 4), ENTRY(1, 4), ENTRY(2, 4), ENTRY(3, 4), ENTRY(4, 4),
+  ENTRY(0, 5), ENTRY(1, 5), ENTRY(2, 5), ENTRY(3, 5), ENTRY(4, 5),
+  ENTRY(5, 5),
+  ENTRY(0, 6), ENTRY(1, 6), ENTRY(2, 6), ENTRY(3, 6), ENTRY(4, 6),
+  ENTRY(5, 6), ENTRY(6, 6),
+};
+
+#define NUM_CONFIGS (sizeof(configs) / sizeof(configs[0]))
+
+#if DEBOUNCE_MAX_WINDOW != 6
+  #error configs only cover windows up to 6
+#endif
+
+/*-----------------------------------------------------------*/
+/* Reference models */
+
+// state machine of pollPin() before the tables were introduced
+#define RELEASED          0
+#define BOUNCED_RELEASED  10
+#define PRESSED           100
+#define BOUNCED_PRESSED   110
+#define INPUT_UNSTABLE    250
+
+static void emit(Trace *trace, PinEvent event, portTickType tick) {
+  if (event == UNASSIGNED)
+    return;
+  trace->event[trace->num] = event;
+  trace->tick[trace->num] = tick;
+  trace->num++;
+}
+
+static void originalButton(Trace *trace, u8 *status, u8 data,
+                           PinListener *listener, portTickType tick) {
+  switch (*status) {
+    case RELEASED:
+      if (data == 1)
+        (*status)++;
+      break;
+    case RELEASED + 1:
+      *status = data == 1 ? RELEASED + 2 : BOUNCED_RELEASED;
+      break;
+    case RELEASED + 2:
+    case BOUNCED_RELEASED + 1:
+      if (data == 1) {
+        *status = PRESSED;
+        emit(trace, listener->risingEvent, tick);
+      } else {
+        *status = INPUT_UNSTABLE;
+      }
+      break;
+    case BOUNCED_RELEASED:
+      *status = data == 1 ? BOUNCED_RELEASED + 1 : INPUT_UNSTABLE;
+      break;
+
+    case PRESSED:
+      if (data == 0)
+        (*status)++;
+      break;
+    case PRESSED + 1:
+      *status = data == 0 ? PRESSED + 2 : BOUNCED_PRESSED;
+      break;
+    case PRESSED + 2:
+    case BOUNCED_PRESSED + 1:
+      if (data == 0) {
+        *status = RELEASED;
+        emit(trace, listener->fallingEvent, tick);
+      } else {
+        *status = INPUT_UNSTABLE;
+      }
+      break;
+    case BOUNCED_PRESSED:
+      *status = data == 0 ? BOUNCED_PRESSED + 1 : INPUT_UNSTABLE;
+      break;
+
+    default:
+      break;
+  }
+  trace->unstable = *status == INPUT_UNSTABLE;
+}
+
+static void originalSensor(Trace *trace, u8 *status, u8 data,
+                           PinListener *listener, portTickType tick) {
+  if (*status == RELEASED && data == 1) {
+    *status = PRESSED;
+    emit(trace, listener->risingEvent, tick);
+  } else if (*status == PRESSED && data == 0) {
+    *status = RELEASED;
+    emit(trace, listener->fallingEvent, tick);
+  }
+}
+
+// can "needed" consecutive differing samples still be seen, given
+// "run" of them so far and "left" samples to come? Tried out on
+// every continuation of the input
+static bool canAccept(int run, int needed, int left) {
+  if (run >= needed)
+    return TRUE;
+  if (left == 0)
+    return FALSE;
+  return canAccept(run + 1, needed, left - 1) ||
+         canAccept(0, needed, left - 1);
+}
+
+typedef struct {
+  u8 level;
+  bool debouncing;
+  int elapsed, run;
+} Definition;
+
+static void definition(Trace *trace, Definition *d, u8 data,
+                       const Config *config, PinListener *listener,
+                       portTickType tick) {
+  bool accept = FALSE;
+
+  if (trace->unstable)
+    return;
+
+  if (!d->debouncing) {
+    if (data == d->level)
+      return;
+    d->debouncing = TRUE;
+    d->elapsed = 0;
+    d->run = 0;
+  } else {
+    d->elapsed++;
+    d->run = data != d->level ? d->run + 1 : 0;
+  }
+
+  if (d->run >= config->length) {
+    accept = TRUE;
+  } else if (!canAccept(d->run, config->length,
+                        config->window - d->elapsed)) {
+    d->debouncing = FALSE;
+    trace->unstable = TRUE;
+  }
+
+  if (accept) {
+    d->debouncing = FALSE;
+    d->level ^= 1;
+    // call buttons only report the press
+    if (d->level || listener->fallingEvent != UNASSIGNED)
+      emit(trace, d->level ? listener->risingEvent : listener->fallingEvent,
+           tick);
+  }
+}
+
+/*-----------------------------------------------------------*/
+
+static PinListenerSet set;
+static u32 sequences, mismatches;
+
+static bool sameTrace(const Trace *a, const Trace *b) {
+  int i;
+
+  if (a->num != b->num || a->unstable != b->unstable)
+    return FALSE;
+  for (i = 0; i < a->num; ++i) {
+    if (a->event[i] != b->event[i] || a->tick[i] != b->tick[i])
+      return FALSE;
+  }
+  return TRUE;
+}
+
+static void mismatch(const char *what, const Config *config, u8 level,
+                     u32 bits, int length, int upTo) {
+  int i;
+
+  fprintf(stderr, "%s: table (%u, %u) differs from level %u on input ",
+          what, config->length, config->window, level);
+  for (i = 0; i < length; ++i)
+    fputc(i < upTo ? '0' + ((bits >> i) & 1) : '.', stderr);
+  fputc('\n', stderr);
+  mismatches++;
+}
+
+typedef enum { ORIGINAL_BUTTON, ORIGINAL_SENSOR, DEFINITION } Reference;
+
+/**
+ * Feed one input sequence (bit i is sample i) to samplePort and to
+ * the reference, comparing after every sample
+ */
+static void check(const Config *config, Reference reference,
+                  PinListener *listener, u8 level, u32 bits, int length) {
+  static const char *names[] = { "original button", "original sensor",
+                                 "definition" };
+  PinPort *port = set.ports;
+  Trace actual, expected;
+  Definition d;
+  u8 status, data;
+  int i;
+
+  listener->debounce = config->table;
+  listener->state = 0;
+  listener->phase = 0;
+  listener->confirmed = 0;
+
+  port->gpio = GPIOA;
+  port->listeners = listener;
+  port->num = 1;
+  port->stable = level ? PIN : 0;
+  port->transient = port->unstable = port->pendingPins = 0;
+
+  actual.num = expected.num = 0;
+  actual.unstable = expected.unstable = FALSE;
+  status = level ? PRESSED : RELEASED;
+  d.level = level;
+  d.debouncing = FALSE;
+  published = &actual;
+
+  for (i = 0; i < length; ++i) {
+    data = (bits >> i) & 1;
+
+    samplePort(&set, port, data ? PIN : 0, (portTickType)i);
+    actual.unstable = (port->unstable & PIN) != 0;
+
+    switch (reference) {
+      case ORIGINAL_BUTTON:
+        originalButton(&expected, &status, data, listener, (portTickType)i);
+        break;
+      case ORIGINAL_SENSOR:
+        originalSensor(&expected, &status, data, listener, (portTickType)i);
+        break;
+      default:
+        definition(&expected, &d, data, config, listener, (portTickType)i);
+        break;
+    }
+
+    if (!sameTrace(&actual, &expected)) {
+      mismatch(names[reference], config, level, bits, length, i + 1);
+      return;
+    }
+  }
+  sequences++;
+}
+
+static void checkAll(const Config *config, Reference reference,
+                     PinListener *listener, int maxLength) {
+  u32 bits;
+  u8 level;
+
+  for (level = 0; level <= 1; ++level) {
+    // the original state machines start released
+    if (level && reference != DEFINITION)
+      continue;
+    for (bits = 0; bits < ((u32)1 << maxLength); ++bits)
+      check(config, reference, listener, level, bits, maxLength);
+  }
+}
+
+// every entry is "stable", a decision, or a transient state in range
+static void checkEncoding(const Config *config) {
+  u8 next;
+  int s, d;
+
+  for (s = 0; s < DEBOUNCE_STATES; ++s) {
+    for (d = 0; d < 2; ++d) {
+      next = (*config->table)[s][d];
+      if (next != DEBOUNCE_ACCEPT && next != DEBOUNCE_UNSTABLE &&
+          next >= DEBOUNCE_STATES) {
+        fprintf(stderr, "table (%u, %u): state %d -> %u out of range\n",
+                config->length, config->window, s, next);
+        mismatches++;
+      }
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  // the stop button reports both edges, call buttons only the press
+  PinListener stopButton = { GPIOA, PIN, STOP_PRESSED, STOP_RELEASED };
+  PinListener callButton = { GPIOA, PIN, TO_FLOOR_1, UNASSIGNED };
+  PinListener sensor = { GPIOA, PIN, ARRIVED_AT_FLOOR, LEFT_FLOOR };
+  int length = 14;
+  u32 i;
+
+  if (argc > 1)
+    length = atoi(argv[1]);
+  if (length < 1 || length > MAX_LENGTH) {
+    fprintf(stderr, "length must be 1..%d\n", MAX_LENGTH);
+    return 2;
+  }
+
+  set.pinEventQueue = (xQueueHandle)&set;
+  set.samplesPerPoll = 1;
+  set.numPorts = 1;
+
+  checkAll(&configs[8], ORIGINAL_BUTTON, &stopButton, length);
+  checkAll(&configs[8], ORIGINAL_BUTTON, &callButton, length);
+  checkAll(&configs[0], ORIGINAL_SENSOR, &sensor, length);
+
+  for (i = 0; i < NUM_CONFIGS; ++i) {
+    checkEncoding(configs + i);
+    checkAll(configs + i, DEFINITION, &stopButton, length);
+    checkAll(configs + i, DEFINITION, &callButton, length);
+  }
+
+  printf("%lu sequences of %d samples checked, %lu mismatches\n",
+         (unsigned long)sequences, length, (unsigned long)mismatches);
+  return mismatches ? 1 : 0;
+}
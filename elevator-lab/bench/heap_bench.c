@@ -0,0 +1,241 @@
+/**
+ * Program skeleton for the course "Programming embedded systems"
+ *
+ * Lab 1: the elevator control system
+ */
+
+/**
+ * Host benchmark of the heap (FreeRTOS/src/heap_tlsf.c).
+ *
+ * The unmodified allocator, with the heap size of FreeRTOSConfig.h, is
+ * exercised with allocation patterns of the elevator: the objects
+ * created at startup stay allocated, and on top of them
+ *
+ *   trips        per-trip buffers and queues are created and deleted,
+ *                with random sizes and lifetimes
+ *   reconfigure  tasks (TCB and stack) are deleted and created again
+ *                with different stack sizes, between trip buffers
+ *
+ * For each pattern, the mean and worst time per operation, the number
+ * of failed allocations and the state of the heap at the end are
+ * reported. Afterwards everything is freed, and the heap has to be a
+ * single free block again.
+ *
+ * Build and run on the host (from this directory):
+ *
+ *   gcc -O2 -DconfigSUPPORT_DYNAMIC_ALLOCATION=1 \
+ *       -I.. -I../FreeRTOS/inc -I../STM32F10xFWLib/inc \
+ *       -o heap_bench heap_bench.c ../FreeRTOS/src/heap_tlsf.c
+ *
+ *   ./heap_bench [operations] [seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "stm32f10x_type.h"
+
+// sizes of the kernel objects on the target (bytes)
+#define TCB_SIZE     92
+#define QUEUE_SIZE   76
+
+#define MAX_TASKS    12
+#define MAX_TRIPS    16
+
+typedef struct {
+  void *tcb, *stack;
+} Task;
+
+typedef struct {
+  void *buffer, *queue;
+  u32 expires;        // trip after which the objects are deleted
+} Trip;
+
+// stack sizes (words) of the tasks created by main.c
+static const u16 stackSizes[MAX_TASKS] =
+  { 100, 80, 80, 100, 100, 120, 120, 120, 120, 120, 120, 128 };
+
+static Task tasks[MAX_TASKS];
+static Trip trips[MAX_TRIPS];
+static void *eventQueue, *mutexes[3];
+
+static u32 operations, failures;
+static double totalNs, worstNs;
+
+/*-----------------------------------------------------------*/
+/* Kernel services used by the allocator */
+
+void vTaskSuspendAll(void) {
+}
+
+signed portBASE_TYPE xTaskResumeAll(void) {
+  return pdFALSE;
+}
+
+/*-----------------------------------------------------------*/
+
+static u32 seed = 1;
+
+static u32 nextRandom(void) {
+  seed = seed * 1103515245 + 12345;
+  return seed >> 8;
+}
+
+static double now(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+static void account(double start) {
+  double ns = now() - start;
+
+  operations++;
+  totalNs += ns;
+  if (ns > worstNs)
+    worstNs = ns;
+}
+
+static void *allocate(size_t size) {
+  double start = now();
+  void *p = pvPortMalloc(size);
+
+  account(start);
+  if (p == NULL)
+    failures++;
+  return p;
+}
+
+static void release(void *p) {
+  double start;
+
+  if (p == NULL)
+    return;
+  start = now();
+  vPortFree(p);
+  account(start);
+}
+
+/*-----------------------------------------------------------*/
+
+static void createTask(Task *task, u16 words) {
+  task->tcb = allocate(TCB_SIZE);
+  task->stack = allocate(words * 4);
+}
+
+static void deleteTask(Task *task) {
+  release(task->stack);
+  release(task->tcb);
+  task->tcb = task->stack = NULL;
+}
+
+static void startup(void) {
+  u32 i;
+
+  for (i = 0; i < MAX_TASKS; ++i)
+    createTask(tasks + i, stackSizes[i]);
+  eventQueue = allocate(QUEUE_SIZE + 32 * 8);
+  for (i = 0; i < 3; ++i)
+    mutexes[i] = allocate(QUEUE_SIZE);
+}
+
+// delete the objects of expired trips and start a new trip
+static void trip(u32 number) {
+  Trip *t;
+
+  for (t = trips; t < trips + MAX_TRIPS; ++t)
+    if (t->buffer != NULL && t->expires <= number) {
+      release(t->queue);
+      release(t->buffer);
+      t->buffer = t->queue = NULL;
+    }
+
+  for (t = trips; t < trips + MAX_TRIPS; ++t)
+    if (t->buffer == NULL) {
+      t->buffer = allocate(32 + nextRandom() % 480);
+      t->queue = allocate(QUEUE_SIZE + 8 * (4 + nextRandom() % 13));
+      t->expires = number + 1 + nextRandom() % MAX_TRIPS;
+      if (t->buffer == NULL) {
+        // the trip cannot be served; the slot has to stay free
+        release(t->queue);
+        t->queue = NULL;
+      }
+      return;
+    }
+}
+
+static void reconfigure(void) {
+  Task *task = tasks + nextRandom() % MAX_TASKS;
+
+  deleteTask(task);
+  createTask(task, 60 + nextRandom() % 140);
+}
+
+static void cleanup(void) {
+  Trip *t;
+  u32 i;
+
+  for (t = trips; t < trips + MAX_TRIPS; ++t) {
+    release(t->queue);
+    release(t->buffer);
+    t->buffer = t->queue = NULL;
+  }
+  for (i = 0; i < MAX_TASKS; ++i)
+    deleteTask(tasks + i);
+  release(eventQueue);
+  for (i = 0; i < 3; ++i)
+    release(mutexes[i]);
+}
+
+static void report(const char *pattern) {
+  xHeapStatsType stats;
+
+  vPortGetHeapStats(&stats);
+  printf("%-12s %9lu ops, %6.1f ns/op mean, %8.1f ns worst, "
+         "%lu failed; %5lu bytes free, largest block %5lu, "
+         "%2u%% fragmented, min free %lu\n",
+         pattern, operations, totalNs / operations, worstNs, failures,
+         (u32)stats.xFreeBytes, (u32)stats.xLargestFreeBlock,
+         (unsigned)stats.uxFragmentation,
+         (u32)stats.xMinimumEverFreeBytes);
+}
+
+static void bench(const char *pattern, u32 rounds, bool reconfiguring) {
+  xHeapStatsType stats;
+  u32 i;
+
+  operations = failures = 0;
+  totalNs = worstNs = 0;
+
+  startup();
+  for (i = 0; i < rounds; ++i) {
+    trip(i);
+    if (reconfiguring && i % 4 == 0)
+      reconfigure();
+  }
+  report(pattern);
+
+  // everything has to be merged into a single block again
+  cleanup();
+  vPortGetHeapStats(&stats);
+  if (stats.uxFragmentation != 0) {
+    printf("%s: heap not coalesced after freeing everything\n", pattern);
+    exit(1);
+  }
+}
+
+int main(int argc, char **argv) {
+  u32 rounds = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+
+  seed = argc > 2 ? strtoul(argv[2], NULL, 10) : 1;
+
+  printf("heap of %u bytes\n", (unsigned)configTOTAL_HEAP_SIZE);
+  bench("trips", rounds, FALSE);
+  bench("reconfigure", rounds, TRUE);
+  return 0;
+}
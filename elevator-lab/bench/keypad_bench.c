@@ -0,0 +1,160 @@
+/**
+ * Program skeleton for the course "Programming embedded systems"
+ *
+ * Lab 1: the elevator control system
+ */
+
+/**
+ * Host benchmark of the keypad matrix scan (keypad.c).
+ *
+ * The unmodified driver is linked against simulated ports: the
+ * column port returns the keys of the row currently pulled low.
+ * A full scan is run on an idle matrix and on a matrix in which
+ * keys are pressed, bounce and are released all the time.
+ *
+ * The time per scan and per key is measured on the host and is
+ * only meant for comparing versions of the driver; it says nothing
+ * about the cycles a scan takes on the STM32. What carries over to
+ * the target are the port reads per scan (one per row) and the
+ * events sent. The settle time after selecting a row is a property
+ * of the wiring, so it is left out (KEYPAD_SETTLE_LOOPS is set to
+ * 0) and has to be added per row on the target.
+ *
+ * Build and run on the host (from this directory):
+ *
+ *   gcc -O2 -DKEYPAD_SETTLE_LOOPS=0 -I.. -I../FreeRTOS/inc \
+ *       -I../STM32F10xFWLib/inc -o keypad_bench keypad_bench.c ../keypad.c
+ *
+ *   ./keypad_bench [scans]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+#include "keypad.h"
+
+static GPIO_TypeDef rowPort, colPort;
+static u16 pressed[KEYPAD_MAX_ROWS];   // keys held down, per row
+static u32 sentEvents, portReads;
+
+static PinEvent events[KEYPAD_MAX_ROWS * 16];
+
+/*-----------------------------------------------------------*/
+/* Peripherals and kernel services used by the driver */
+
+void GPIO_Init(GPIO_TypeDef* GPIOx, GPIO_InitTypeDef* GPIO_InitStruct) {
+}
+
+u16 GPIO_ReadInputData(GPIO_TypeDef* GPIOx) {
+  u32 select = rowPort.BSRR >> 16;
+
+  portReads++;
+  if (!select)
+    return 0xFFFF;
+  return ~pressed[__builtin_ctz(select)];
+}
+
+signed portBASE_TYPE xTaskGenericCreate(pdTASK_CODE pvTaskCode,
+                                        const signed char * const pcName,
+                                        unsigned short usStackDepth,
+                                        void *pvParameters,
+                                        unsigned portBASE_TYPE uxPriority,
+                                        xTaskHandle *pxCreatedTask,
+                                        portSTACK_TYPE *puxStackBuffer,
+                                        xStaticTaskType *pxTaskBuffer,
+                                        const xMemoryRegion * const xRegions) {
+  return pdTRUE;
+}
+
+portTickType xTaskGetTickCount(void) {
+  return 0;
+}
+
+void vTaskDelayUntil(portTickType * const pxPreviousWakeTime,
+                     portTickType xTimeIncrement) {
+}
+
+signed portBASE_TYPE xQueueGenericSend(xQueueHandle xQueue,
+                                       const void * const pvItemToQueue,
+                                       portTickType xTicksToWait,
+                                       portBASE_TYPE xCopyPosition) {
+  sentEvents++;
+  return pdTRUE;
+}
+
+void assert_failed(u8* file, u32 line) {
+  printf("ASSERTION FAILURE: %s:%lu\n", file, line);
+  exit(1);
+}
+
+/*-----------------------------------------------------------*/
+
+static u32 seed = 1;
+
+static u32 nextRandom(void) {
+  seed = seed * 1103515245 + 12345;
+  return seed >> 8;
+}
+
+// press, bounce or release a random key about every fourth scan
+static void disturb(u8 rows, u8 cols) {
+  u32 r = nextRandom();
+
+  if (r & 3)
+    return;
+  r >>= 2;
+  pressed[r % rows] ^= 1 << ((r / rows) % cols);
+}
+
+static void bench(u8 rows, u8 cols, u32 scans, bool busy) {
+  Keypad keypad;
+  clock_t start;
+  double ns;
+  u32 i;
+
+  memset(&keypad, 0, sizeof(keypad));
+  memset(pressed, 0, sizeof(pressed));
+  keypad.rowGpio = &rowPort;
+  keypad.rowPins = (u16)((1 << rows) - 1);
+  keypad.colGpio = &colPort;
+  keypad.colPins = (u16)((1 << cols) - 1);
+  keypad.pressEvents = events;
+  keypad.releaseEvents = events;
+  keypad.scanPeriod = 5;
+  setupKeypad(&keypad);
+  sentEvents = 0;
+  portReads = 0;
+
+  start = clock();
+  for (i = 0; i < scans; ++i) {
+    if (busy)
+      disturb(rows, cols);
+    scanKeypad(&keypad);
+  }
+  ns = (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / scans;
+
+  printf("%2ux%-2u %s: %5.2f port reads/scan, %lu events, "
+         "host only: %7.1f ns/scan, %5.2f ns/key\n",
+         rows, cols, busy ? "busy" : "idle", (double)portReads / scans,
+         sentEvents, ns, ns / (rows * cols));
+}
+
+int main(int argc, char **argv) {
+  u32 scans = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+  u32 i;
+
+  for (i = 0; i < KEYPAD_MAX_ROWS * 16; ++i)
+    events[i] = TO_FLOOR_1 + i % 3;
+
+  bench(8, 8, scans, FALSE);
+  bench(8, 8, scans, TRUE);
+  bench(16, 16, scans, FALSE);
+  bench(16, 16, scans, TRUE);
+  return 0;
+}
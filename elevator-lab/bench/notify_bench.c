@@ -0,0 +1,407 @@
+/**
+ * Program skeleton for the course "Programming embedded systems"
+ *
+ * Lab 1: the elevator control system
+ */
+
+/**
+ * Host benchmark of direct-to-task notifications (FreeRTOS/src/tasks.c),
+ * compared with a binary semaphore and a queue of one u32 item.
+ *
+ * The unmodified kernel (tasks.c, queue.c and list.c) is linked against
+ * a port that runs every task on its own host stack and switches between
+ * them with setjmp/longjmp; there are no interrupts, so the critical
+ * sections are empty. For each mechanism, the mean time is reported for
+ *
+ *   task      a task signals a task of higher priority, which wakes up,
+ *             takes the signal and blocks again
+ *   isr       as "task", but signalled from (simulated) interrupt context
+ *             with the FromISR function and portEND_SWITCHING_ISR
+ *   no-block  a task signals itself and takes the signal, without any
+ *             task being blocked or woken
+ *
+ * together with the RAM needed on the host. On the target, a binary
+ * semaphore takes 76 bytes (xStaticQueueType), the queue 76 + 4 bytes,
+ * and a notification 8 bytes, which are part of every TCB whether the
+ * task is notified or not.
+ *
+ * Build and run on the host (from this directory):
+ *
+ *   gcc -O2 -D__clz=__builtin_clz -I.. -I../FreeRTOS/inc \
+ *       -I../STM32F10xFWLib/inc -o notify_bench notify_bench.c \
+ *       ../FreeRTOS/src/tasks.c ../FreeRTOS/src/queue.c ../FreeRTOS/src/list.c
+ *
+ *   ./notify_bench [signals]
+ */
+
+// longjmp between the task stacks is intended, so the fortified
+// version, which rejects it, must not be used
+#undef _FORTIFY_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+#include "stm32f10x_type.h"
+
+#define MAX_TASKS        5
+#define HOST_STACK_SIZE  (64 * 1024)
+#define BENCH_STACK_SIZE configMINIMAL_STACK_SIZE
+
+#define DWT_BASE         0xe0001000
+
+typedef struct {
+  portSTACK_TYPE *topOfStack;   // as returned to the kernel, identifies
+                                // the task in pxCurrentTCB
+  pdTASK_CODE code;
+  void *params;
+  bool started;
+  ucontext_t entry;             // only used to enter the task once
+  jmp_buf context;
+  char stack[HOST_STACK_SIZE];
+} HostTask;
+
+typedef struct {
+  const char *name;
+  void (*signal)(void);         // signal the waiting task
+  void (*signalFromISR)(void);  // same, from an interrupt handler
+  void (*wait)(void);           // block until signalled
+  void (*signalAndTake)(void);  // signal and take without blocking
+  xTaskHandle waiter;
+  u32 received;
+  xStaticTaskType taskBuffer;
+  portSTACK_TYPE stack[BENCH_STACK_SIZE];
+} Mechanism;
+
+static HostTask hostTasks[MAX_TASKS];
+static int numHostTasks;
+static HostTask *running;
+
+static u32 signals = 1000000;
+
+static xSemaphoreHandle semaphore, ownSemaphore;
+static xQueueHandle queue, ownQueue;
+static xStaticQueueType semaphoreBuffer, ownSemaphoreBuffer;
+static xStaticQueueType queueBuffer, ownQueueBuffer;
+static u8 queueStorage[sizeof(u32)], ownQueueStorage[sizeof(u32)];
+
+static xTaskHandle driver;
+static xStaticTaskType driverTaskBuffer;
+static portSTACK_TYPE driverStack[BENCH_STACK_SIZE];
+
+/*-----------------------------------------------------------*/
+/* Port layer */
+
+static void trampoline(int index) {
+  hostTasks[index].code(hostTasks[index].params);
+  fprintf(stderr, "task returned\n");
+  exit(1);
+}
+
+portSTACK_TYPE *pxPortInitialiseStack(portSTACK_TYPE *pxTopOfStack,
+                                      pdTASK_CODE pxCode,
+                                      void *pvParameters) {
+  HostTask *task = hostTasks + numHostTasks;
+
+  if (numHostTasks == MAX_TASKS) {
+    fprintf(stderr, "too many tasks\n");
+    exit(1);
+  }
+
+  task->topOfStack = pxTopOfStack;
+  task->code = pxCode;
+  task->params = pvParameters;
+  task->started = FALSE;
+
+  getcontext(&task->entry);
+  task->entry.uc_stack.ss_sp = task->stack;
+  task->entry.uc_stack.ss_size = sizeof(task->stack);
+  task->entry.uc_link = NULL;
+  makecontext(&task->entry, (void (*)(void))trampoline, 1, numHostTasks);
+
+  numHostTasks++;
+  return pxTopOfStack;
+}
+
+// the host task that the kernel has selected to run
+static HostTask *currentHostTask(void) {
+  portSTACK_TYPE *topOfStack =
+    *(portSTACK_TYPE **)xTaskGetCurrentTaskHandle();
+  int i;
+
+  for (i = 0; i < numHostTasks; ++i) {
+    if (hostTasks[i].topOfStack == topOfStack)
+      return hostTasks + i;
+  }
+  fprintf(stderr, "unknown task\n");
+  exit(1);
+}
+
+static void switchTo(HostTask *next) {
+  HostTask *prev = running;
+
+  if (next == prev)
+    return;
+
+  running = next;
+  if (prev != NULL && _setjmp(prev->context))
+    return;
+
+  if (next->started)
+    _longjmp(next->context, 1);
+
+  next->started = TRUE;
+  setcontext(&next->entry);
+}
+
+void vPortYieldFromISR(void) {
+  vTaskSwitchContext();
+  switchTo(currentHostTask());
+}
+
+void vPortYield(void) {
+  vPortYieldFromISR();
+}
+
+portBASE_TYPE xPortStartScheduler(void) {
+  switchTo(currentHostTask());
+  return pdFALSE;
+}
+
+void vPortEndScheduler(void) {
+}
+
+void vPortEnterCritical(void) {
+}
+
+void vPortExitCritical(void) {
+}
+
+void vPortSetInterruptMask(void) {
+}
+
+void vPortClearInterruptMask(void) {
+}
+
+void vPortSuppressTicksAndSleep(portTickType xExpectedIdleTime) {
+}
+
+void vConfigureTimerForRunTimeStats(void) {
+}
+
+void vApplicationStackOverflowHook(xTaskHandle *pxTask,
+                                   signed portCHAR *pcTaskName) {
+  fprintf(stderr, "stack overflow in %s\n", (char*)pcTaskName);
+  exit(1);
+}
+
+void assert_failed(u8* file, u32 line) {
+  fprintf(stderr, "assertion failed: %s:%lu\n", (char*)file, (unsigned long)line);
+  exit(1);
+}
+
+/*-----------------------------------------------------------*/
+/* Signalling mechanisms */
+
+static void semaphoreSignal(void) {
+  xSemaphoreGive(semaphore);
+}
+
+static void semaphoreSignalFromISR(void) {
+  signed portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+  xSemaphoreGiveFromISR(semaphore, &xHigherPriorityTaskWoken);
+  portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+}
+
+static void semaphoreWait(void) {
+  xSemaphoreTake(semaphore, portMAX_DELAY);
+}
+
+static void semaphoreSignalAndTake(void) {
+  xSemaphoreGive(ownSemaphore);
+  xSemaphoreTake(ownSemaphore, 0);
+}
+
+static void queueSignal(void) {
+  u32 value = 1;
+
+  xQueueSend(queue, &value, 0);
+}
+
+static void queueSignalFromISR(void) {
+  signed portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+  u32 value = 1;
+
+  xQueueSendFromISR(queue, &value, &xHigherPriorityTaskWoken);
+  portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+}
+
+static void queueWait(void) {
+  u32 value;
+
+  xQueueReceive(queue, &value, portMAX_DELAY);
+}
+
+static void queueSignalAndTake(void) {
+  u32 value = 1;
+
+  xQueueSend(ownQueue, &value, 0);
+  xQueueReceive(ownQueue, &value, 0);
+}
+
+static Mechanism mechanisms[3];
+
+static void notifySignal(void) {
+  xTaskNotifyGive(mechanisms[2].waiter);
+}
+
+static void notifySignalFromISR(void) {
+  signed portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+  vTaskNotifyGiveFromISR(mechanisms[2].waiter, &xHigherPriorityTaskWoken);
+  portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+}
+
+static void notifyWait(void) {
+  ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+static void notifySignalAndTake(void) {
+  xTaskNotifyGive(driver);
+  ulTaskNotifyTake(pdTRUE, 0);
+}
+
+static Mechanism mechanisms[3] = {
+  { "semaphore", semaphoreSignal, semaphoreSignalFromISR,
+    semaphoreWait, semaphoreSignalAndTake },
+  { "queue", queueSignal, queueSignalFromISR,
+    queueWait, queueSignalAndTake },
+  { "notification", notifySignal, notifySignalFromISR,
+    notifyWait, notifySignalAndTake },
+};
+
+#define NUM_MECHANISMS (sizeof(mechanisms) / sizeof(mechanisms[0]))
+
+/*-----------------------------------------------------------*/
+
+static double now(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+// mean time (ns) of "signal", which has to wake up the waiter each time
+static double timeSignals(Mechanism *mechanism, void (*signal)(void)) {
+  u32 received = mechanism->received;
+  double start = now();
+  u32 i;
+
+  for (i = 0; i < signals; ++i)
+    signal();
+
+  start = now() - start;
+  if (mechanism->received - received != signals) {
+    fprintf(stderr, "%s: %lu of %lu signals received\n", mechanism->name,
+            (unsigned long)(mechanism->received - received),
+            (unsigned long)signals);
+    exit(1);
+  }
+  return start / signals;
+}
+
+static double timeSignalAndTake(Mechanism *mechanism) {
+  double start = now();
+  u32 i;
+
+  for (i = 0; i < signals; ++i)
+    mechanism->signalAndTake();
+
+  return (now() - start) / signals;
+}
+
+static void waiterTask(void *params) {
+  Mechanism *mechanism = (Mechanism*)params;
+
+  for (;;) {
+    mechanism->wait();
+    mechanism->received++;
+  }
+}
+
+static void driverTask(void *params) {
+  Mechanism *mechanism;
+  u32 i;
+
+  printf("%lu signals\n", (unsigned long)signals);
+  printf("%-13s %9s %9s %9s\n", "", "task", "isr", "no-block");
+
+  for (i = 0; i < NUM_MECHANISMS; ++i) {
+    mechanism = mechanisms + i;
+    printf("%-13s", mechanism->name);
+    printf(" %6.1f ns", timeSignals(mechanism, mechanism->signal));
+    printf(" %6.1f ns", timeSignals(mechanism, mechanism->signalFromISR));
+    printf(" %6.1f ns\n", timeSignalAndTake(mechanism));
+  }
+
+  printf("RAM (host): semaphore %u bytes, queue %u + %u bytes, "
+         "notification %u bytes in every TCB\n",
+         (unsigned)sizeof(xStaticQueueType),
+         (unsigned)sizeof(xStaticQueueType), (unsigned)sizeof(u32),
+         (unsigned)(sizeof(xStaticTaskType) -
+                    offsetof(xStaticTaskType, ulDummy15)));
+  exit(0);
+}
+
+int main(int argc, char **argv) {
+  portBASE_TYPE res;
+  u32 i;
+
+  if (argc > 1)
+    signals = strtoul(argv[1], NULL, 0);
+
+  // the kernel reads the DWT cycle counter for the run-time statistics
+  if (mmap((void*)DWT_BASE, 4096, PROT_READ | PROT_WRITE,
+           MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED) {
+    perror("mmap");
+    return 1;
+  }
+
+  // the semaphores are created given; take them, so that the first
+  // signal already has to wake up the waiter
+  vSemaphoreCreateBinaryStatic(semaphore, &semaphoreBuffer);
+  vSemaphoreCreateBinaryStatic(ownSemaphore, &ownSemaphoreBuffer);
+  xSemaphoreTake(semaphore, 0);
+  xSemaphoreTake(ownSemaphore, 0);
+
+  queue = xQueueCreateStatic(1, sizeof(u32), queueStorage, &queueBuffer);
+  ownQueue = xQueueCreateStatic(1, sizeof(u32), ownQueueStorage,
+                                &ownQueueBuffer);
+
+  for (i = 0; i < NUM_MECHANISMS; ++i) {
+    res = xTaskCreateStatic(waiterTask, (const signed char*)"waiter",
+                            BENCH_STACK_SIZE, mechanisms + i,
+                            tskIDLE_PRIORITY + 2, &mechanisms[i].waiter,
+                            mechanisms[i].stack, &mechanisms[i].taskBuffer);
+    if (res != pdTRUE)
+      return 1;
+  }
+
+  res = xTaskCreateStatic(driverTask, (const signed char*)"driver",
+                          BENCH_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1,
+                          &driver, driverStack, &driverTaskBuffer);
+  if (res != pdTRUE)
+    return 1;
+
+  vTaskStartScheduler();
+  return 1;
+}
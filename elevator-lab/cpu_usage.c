@@ -0,0 +1,91 @@
+/**
+ * Program skeleton for the course "Programming embedded systems"
+ *
+ * Lab 1: the elevator control system
+ */
+
+/**
+ * CPU usage statistics: the share of the processor used by each
+ * task, measured by the kernel with the DWT cycle counter, and the
+ * rate of context switches
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "cpu_usage.h"
+#include "logger.h"
+#include "assert.h"
+
+#define DEMCR         (*(vu32*)0xE000EDFC)
+#define DEMCR_TRCENA  0x01000000
+#define DWT_CTRL      (*(vu32*)0xE0001000)
+#define DWT_CYCCNTENA 0x00000001
+
+#define CYCLES_PER_TICK (configCPU_CLOCK_HZ / configTICK_RATE_HZ)
+
+#define CPU_USAGE_STACK_SIZE 120
+
+static xTaskRunTimeType counters[CPU_USAGE_MAX_TASKS];
+
+static portTickType reportPeriod;
+
+static xStaticTaskType cpuUsageTaskBuffer;
+static portSTACK_TYPE cpuUsageStack[CPU_USAGE_STACK_SIZE];
+
+void vConfigureTimerForRunTimeStats(void) {
+  // the counter is shared with the safety task, so it is not reset
+  DEMCR |= DEMCR_TRCENA;
+  DWT_CTRL |= DWT_CYCCNTENA;
+}
+
+static void cpuUsageTask(void *params) {
+  portTickType xLastWakeTime;
+  unsigned portBASE_TYPE num, i;
+  u32 switches, lastSwitches, cyclesPerMille, used, total;
+
+  // discard the time used during startup
+  uxTaskGetRunTimeCounters(counters, CPU_USAGE_MAX_TASKS, pdTRUE);
+  lastSwitches = ulTaskGetContextSwitchCount();
+  xLastWakeTime = xTaskGetTickCount();
+
+  for (;;) {
+    vTaskDelayUntil(&xLastWakeTime, reportPeriod);
+
+    // the counters are reset with every read, so they only cover the
+    // last period and never wrap around
+    num = uxTaskGetRunTimeCounters(counters, CPU_USAGE_MAX_TASKS, pdTRUE);
+    switches = ulTaskGetContextSwitchCount();
+
+    // shares are relative to the length of the period rather than to
+    // the sum of the counters: the cycle counter stops while the idle
+    // task sleeps in WFI, and interrupts are charged to the task they
+    // interrupted
+    cyclesPerMille = reportPeriod * (CYCLES_PER_TICK / 1000);
+    total = 0;
+
+    for (i = 0; i < num; ++i) {
+      used = counters[i].ulRunTimeCounter / cyclesPerMille;
+      total += used;
+      logMessage("cpu %s: %lu.%lu%%\n", (u32)counters[i].pcTaskName,
+                 used / 10, used % 10);
+    }
+
+    logMessage("cpu: %lu context switches/s, %lu.%lu%% asleep\n",
+               (switches - lastSwitches) * configTICK_RATE_HZ / reportPeriod,
+               total < 1000 ? (1000 - total) / 10 : 0,
+               total < 1000 ? (1000 - total) % 10 : 0);
+    lastSwitches = switches;
+  }
+}
+
+void setupCpuUsageReport(portTickType period,
+                         unsigned portBASE_TYPE uxPriority) {
+  portBASE_TYPE res;
+
+  reportPeriod = period;
+  res = xTaskCreateStatic(cpuUsageTask, "cpu usage",
+                          CPU_USAGE_STACK_SIZE, NULL, uxPriority, NULL,
+                          cpuUsageStack, &cpuUsageTaskBuffer);
+  assert(res == pdTRUE);
+}
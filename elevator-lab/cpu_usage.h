@@ -0,0 +1,36 @@
+/**
+ * Program skeleton for the course "Programming embedded systems"
+ *
+ * Lab 1: the elevator control system
+ */
+
+/**
+ * CPU usage statistics: the share of the processor used by each
+ * task, measured by the kernel with the DWT cycle counter, and the
+ * rate of context switches
+ */
+
+#ifndef CPU_USAGE_H
+#define CPU_USAGE_H
+
+#include "FreeRTOS.h"
+
+// maximum number of tasks that are reported
+#define CPU_USAGE_MAX_TASKS 16
+
+/**
+ * Start the cycle counter; called by the scheduler through
+ * portCONFIGURE_TIMER_FOR_RUN_TIME_STATS
+ */
+void vConfigureTimerForRunTimeStats(void);
+
+/**
+ * Create a task that logs the utilisation of every task and the
+ * number of context switches per second, each time over the last
+ * "period" ticks. The period has to stay below 59 s, after which
+ * the cycle counter wraps around
+ */
+void setupCpuUsageReport(portTickType period,
+                         unsigned portBASE_TYPE uxPriority);
+
+#endif
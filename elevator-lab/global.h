@@ -20,7 +20,11 @@
 #define TRACKER_FLOOR1_POS	0
 #define TRACKER_FLOOR2_POS	400
 #define TRACKER_FLOOR3_POS	800
-#define SAFE_STOP_DISTANCE	50 //50 cm before target position
+
+#define CAR_MAX_SPEED	50	// cm/s, see environment assumption 2
+#define CAR_MAX_DECELERATION	100	// cm/s^2, see safety requirement 7
+#define CAR_REACTION_TIME	40	// ms until a new target reaches the motor
+                            	// (planner period + motor period)
 
 #define FLOOR_TIMEOUT 100  // 1 second
 
@@ -51,6 +55,15 @@ typedef enum {
   STOP_PRESSED, STOP_RELEASED
 } PinEvent;
 
+/**
+ * Element of the event queue: the event together with the
+ * tick at which the PinListener confirmed the edge
+ */
+typedef struct {
+  PinEvent event;
+  portTickType tick;
+} TimedPinEvent;
+
 
 
 /**
@@ -73,6 +86,12 @@ s32 getCarPosition(void);
  */
 void setCarTargetPosition(s32 target);
 
+/**
+ * Current speed of the car (unit is "cm/s"); positive when
+ * moving upwards, negative when moving downwards
+ */
+s32 getCarSpeed(void);
+
 /**
  * Emergency stop for the elevator motor
  */
@@ -84,6 +103,11 @@ Direction getCarDirection(void);
 //returns the car's target position
 s32 getCarTargetPosition(void);
 
+//copies the car's position and the ticks of the latest PULSE_HISTORY
+//position pulses (oldest first), taken together, and returns the number
+//of pulses seen so far
+u32 getCarPulseHistory(s32 *position, portTickType *ticks);
+
 //returns the next floor where the car should go from the planner
 s32 getPlannerTargetPosition(void);
 
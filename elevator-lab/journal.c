@@ -0,0 +1,271 @@
+/**
+ * Program skeleton for the course "Programming embedded systems"
+ *
+ * Lab 1: the elevator control system
+ */
+
+/**
+ * Persistent journal of safety violations
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stm32f10x_bkp.h"
+#include "stm32f10x_pwr.h"
+#include "stm32f10x_rcc.h"
+#include <stdio.h>
+
+#include "journal.h"
+#include "safety.h"
+#include "assert.h"
+
+#if JOURNAL_USE_SPI_FLASH
+#include "spi_flash.h"
+#endif
+
+// The latest entry is kept in the backup registers DR2..DR9
+// (DR1 belongs to the watchdog)
+#define JOURNAL_WORDS     (sizeof(JournalEntry) / 2)
+#define JOURNAL_BKP_FIRST BKP_DR2
+#define JOURNAL_BKP_STEP  (BKP_DR3 - BKP_DR2)
+
+// Two 64 kB sectors at the end of the 8 MB flash; entries are
+// appended to one sector, and when it is full the other one is
+// erased and used
+#define JOURNAL_BASE      0x7E0000
+#define JOURNAL_SECTOR    0x10000
+#define JOURNAL_SECTORS   2
+#define JOURNAL_ENTRIES   (JOURNAL_SECTOR / sizeof(JournalEntry))
+
+// erased flash reads as all ones
+#define ERASED_SEQUENCE   0xFFFF
+
+static JournalEntry latest;
+static bool latestFlushed = TRUE;
+static u16 nextSequence = 0;
+
+#if JOURNAL_USE_SPI_FLASH
+static u8 activeSector;
+static u32 nextSlot;              // within the active sector
+#endif
+
+static u16 checksum(const JournalEntry *entry) {
+  const u16 *words = (const u16*)entry;
+  u16 sum = 0;
+  u8 i;
+
+  for (i = 0; i < JOURNAL_WORDS - 1; ++i)
+    sum += words[i];
+  return ~sum;
+}
+
+static bool valid(const JournalEntry *entry) {
+  return entry->sequence != ERASED_SEQUENCE &&
+         entry->checksum == checksum(entry);
+}
+
+// is sequence number a newer than b (with wrap-around)?
+static bool newer(u16 a, u16 b) {
+  return (s16)(a - b) > 0;
+}
+
+#if JOURNAL_USE_SPI_FLASH
+
+static u32 slotAddress(u8 sector, u32 slot) {
+  return JOURNAL_BASE + sector * JOURNAL_SECTOR + slot * sizeof(JournalEntry);
+}
+
+static void readSlot(u8 sector, u32 slot, JournalEntry *entry) {
+  SPI_FLASH_BufferRead((u8*)entry, slotAddress(sector, slot),
+                       sizeof(JournalEntry));
+}
+
+/**
+ * The active sector is the one whose first entry is newest;
+ * entries within it are written front to back, so the end is
+ * found by binary search
+ */
+static void findEnd(void) {
+  JournalEntry entry;
+  u32 low, high, mid;
+  u16 newest = 0;
+  bool found = FALSE;
+  u8 sector;
+
+  activeSector = 0;
+  for (sector = 0; sector < JOURNAL_SECTORS; ++sector) {
+    readSlot(sector, 0, &entry);
+    if (entry.sequence != ERASED_SEQUENCE &&
+        (!found || newer(entry.sequence, newest))) {
+      newest = entry.sequence;
+      activeSector = sector;
+      found = TRUE;
+    }
+  }
+
+  if (!found) {
+    nextSlot = 0;
+    return;
+  }
+
+  // first erased slot in the active sector
+  low = 1;
+  high = JOURNAL_ENTRIES;
+  while (low < high) {
+    mid = (low + high) / 2;
+    readSlot(activeSector, mid, &entry);
+    if (entry.sequence == ERASED_SEQUENCE)
+      high = mid;
+    else
+      low = mid + 1;
+  }
+  nextSlot = low;
+
+  readSlot(activeSector, nextSlot - 1, &entry);
+  nextSequence = entry.sequence + 1;
+}
+
+/**
+ * Erasing a sector takes seconds, so it is only done during
+ * setup: when the active sector is full, the next one is
+ * erased before any violation can happen
+ */
+static void prepareSector(void) {
+  if (nextSlot < JOURNAL_ENTRIES)
+    return;
+
+  activeSector = (activeSector + 1) % JOURNAL_SECTORS;
+  SPI_FLASH_SectorErase(slotAddress(activeSector, 0));
+  nextSlot = 0;
+}
+
+static bool appendEntry(const JournalEntry *entry) {
+  // full: the entry stays in the backup registers and is
+  // appended after the next reset
+  if (nextSlot == JOURNAL_ENTRIES)
+    return FALSE;
+
+  // entries never cross a page
+  SPI_FLASH_PageWrite((u8*)entry, slotAddress(activeSector, nextSlot),
+                      sizeof(JournalEntry));
+  nextSlot++;
+  return TRUE;
+}
+
+// the "back"-th newest entry in the flash (0 is the newest)
+static bool readBack(u32 back, JournalEntry *entry) {
+  u8 sector = activeSector, s;
+  u32 slot = nextSlot;
+
+  for (s = 0; back >= slot; ++s) {
+    if (s == JOURNAL_SECTORS - 1)
+      return FALSE;
+    back -= slot;
+    sector = (sector + JOURNAL_SECTORS - 1) % JOURNAL_SECTORS;
+    slot = JOURNAL_ENTRIES;
+  }
+
+  readSlot(sector, slot - 1 - back, entry);
+  return valid(entry);
+}
+
+#else
+
+// Without the flash, the journal consists of the latest entry
+static void findEnd(void) {
+  if (valid(&latest))
+    nextSequence = latest.sequence + 1;
+}
+
+static void prepareSector(void) {
+}
+
+static bool appendEntry(const JournalEntry *entry) {
+  return TRUE;
+}
+
+static bool readBack(u32 back, JournalEntry *entry) {
+  *entry = latest;
+  return back == 0 && valid(entry);
+}
+
+#endif
+
+static void printEntry(const JournalEntry *entry) {
+  printf("violation %u: %s at %lu ms, position %d cm, inputs 0x%04x, duty %d\n",
+         entry->sequence, getRequirementName(entry->requirement),
+         entry->tick * portTICK_RATE_MS, entry->position,
+         entry->inputs, entry->duty);
+}
+
+void recordViolation(u8 requirement, portTickType tick, s32 position,
+                     u16 inputs, s32 duty) {
+  const u16 *words = (const u16*)&latest;
+  u8 i;
+
+  if (nextSequence == ERASED_SEQUENCE)
+    nextSequence = 0;
+
+  latest.sequence = nextSequence++;
+  latest.requirement = requirement;
+  latest.reserved = 0;
+  latest.tick = tick;
+  latest.position = (s16)position;
+  latest.inputs = inputs;
+  latest.duty = (s16)duty;
+  latest.checksum = checksum(&latest);
+  latestFlushed = FALSE;
+
+  for (i = 0; i < JOURNAL_WORDS; ++i)
+    BKP_WriteBackupRegister(JOURNAL_BKP_FIRST + i * JOURNAL_BKP_STEP, words[i]);
+}
+
+void flushJournal(void) {
+  if (!latestFlushed)
+    latestFlushed = appendEntry(&latest);
+}
+
+u8 readJournal(JournalEntry *entries, u8 num) {
+  u8 n;
+
+  for (n = 0; n < num && readBack(n, entries + n); ++n);
+  return n;
+}
+
+void printJournal(u8 num) {
+  JournalEntry entry;
+  u8 i;
+
+  for (i = 0; i < num && readBack(i, &entry); ++i)
+    printEntry(&entry);
+}
+
+void setupJournal(void) {
+  JournalEntry last;
+  u16 *words = (u16*)&latest;
+  u8 i;
+
+  RCC_APB1PeriphClockCmd( RCC_APB1Periph_PWR | RCC_APB1Periph_BKP, ENABLE );
+  PWR_BackupAccessCmd(ENABLE);
+
+  // the latest violation, if it is not in the flash yet
+  for (i = 0; i < JOURNAL_WORDS; ++i)
+    words[i] = BKP_ReadBackupRegister(JOURNAL_BKP_FIRST + i * JOURNAL_BKP_STEP);
+
+#if JOURNAL_USE_SPI_FLASH
+  SPI_FLASH_Init();
+#endif
+  findEnd();
+  prepareSector();
+
+  if (valid(&latest)) {
+    printf("Last safety ");
+    printEntry(&latest);
+
+    if (!readBack(0, &last) || newer(latest.sequence, last.sequence)) {
+      appendEntry(&latest);
+      nextSequence = latest.sequence + 1;
+    }
+  }
+  latestFlushed = TRUE;
+}
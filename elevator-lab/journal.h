@@ -0,0 +1,70 @@
+/**
+ * Program skeleton for the course "Programming embedded systems"
+ *
+ * Lab 1: the elevator control system
+ */
+
+/**
+ * Persistent journal of safety violations. The latest violation
+ * is kept in backup registers, which are written immediately and
+ * survive resets; with JOURNAL_USE_SPI_FLASH, all violations are
+ * also appended to a log-structured area of the SPI flash
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "FreeRTOS.h"
+#include "stm32f10x_type.h"
+
+// Keep the whole journal in the SPI flash of the board. This
+// needs a driver implementing spi_flash.h, which is not part of
+// the project; without it, the journal is the latest violation
+#ifndef JOURNAL_USE_SPI_FLASH
+#define JOURNAL_USE_SPI_FLASH 0
+#endif
+
+typedef struct {
+  u16 sequence;          // number of the violation, counting up
+  u8 requirement;        // id of the violated requirement (safety.h)
+  u8 reserved;
+  u32 tick;              // when the violation was detected
+  s16 position;          // position of the car (cm)
+  u16 inputs;            // GPIOC input data register
+  s16 duty;              // motor duty, positive upwards
+  u16 checksum;          // complement of the sum of the other halfwords
+} JournalEntry;
+
+/**
+ * Initialise the SPI flash and find the end of the journal. A
+ * violation that only made it into the backup registers (e.g.,
+ * because the power was lost) is appended now, and printed
+ */
+void setupJournal(void);
+
+/**
+ * Record a violation in the backup registers (a few cycles).
+ * The entry is appended to the flash by "flushJournal"
+ */
+void recordViolation(u8 requirement, portTickType tick, s32 position,
+                     u16 inputs, s32 duty);
+
+/**
+ * Append the latest violation to the flash (if it is used).
+ * This can take long (up to a sector erase), so it must only
+ * be called once the car has been stopped
+ */
+void flushJournal(void);
+
+/**
+ * Read the latest "num" entries, newest first; returns how
+ * many there were
+ */
+u8 readJournal(JournalEntry *entries, u8 num);
+
+/**
+ * Print the latest "num" entries to the serial port
+ */
+void printJournal(u8 num);
+
+#endif
@@ -0,0 +1,151 @@
+/**
+ * Program skeleton for the course "Programming embedded systems"
+ *
+ * Lab 1: the elevator control system
+ */
+
+/**
+ * Driver for keypad matrices
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stm32f10x_gpio.h"
+
+#include "keypad.h"
+#include "assert.h"
+
+/**
+ * Events are published without blocking, as by the pin
+ * listeners: an event that does not fit into the queue marks
+ * its key as pending and is retried at the next scan; further
+ * changes of a pending key are coalesced with it and counted
+ */
+static void publishKey(Keypad *keypad, u8 row, u16 pin) {
+  TimedPinEvent ev;
+  u8 key = row * keypad->numCols + keypad->colIndex[pin];
+
+  if ((keypad->stable[row] & (1 << pin)) || keypad->releaseEvents == NULL)
+    ev.event = keypad->pressEvents[key];
+  else
+    ev.event = keypad->releaseEvents[key];
+  ev.tick = xTaskGetTickCount();
+
+  if (ev.event == UNASSIGNED ||
+      xQueueSend(keypad->pinEventQueue, &ev, 0) == pdTRUE)
+    keypad->pending[row] &= ~(1 << pin);
+  else
+    keypad->pending[row] |= 1 << pin;
+}
+
+// publish the events of the keys of a row that toggled
+static void publishRow(Keypad *keypad, u8 row, u16 keys) {
+  u16 pin;
+
+  for (pin = 0; keys; ++pin, keys >>= 1) {
+    if (!(keys & 1))
+      continue;
+
+    if (keypad->pending[row] & (1 << pin))
+      keypad->droppedEvents++;
+    else if ((keypad->stable[row] & (1 << pin)) || keypad->releaseEvents != NULL) // no release events for plain buttons
+      publishKey(keypad, row, pin);
+  }
+}
+
+static void publishPendingKeys(Keypad *keypad, u8 row) {
+  u16 pin, keys = keypad->pending[row];
+
+  for (pin = 0; keys; ++pin, keys >>= 1) {
+    if (keys & 1)
+      publishKey(keypad, row, pin);
+  }
+}
+
+void scanKeypad(Keypad *keypad) {
+  u16 sample, delta, toggle, previous;
+  u8 row;
+  vu32 settle;
+
+  previous = keypad->rowSelect[keypad->numRows - 1];
+
+  for (row = 0; row < keypad->numRows; ++row) {
+    // release the previous row and pull the current one low
+    // with a single write
+    keypad->rowGpio->BSRR = previous | ((u32)keypad->rowSelect[row] << 16);
+    previous = keypad->rowSelect[row];
+    for (settle = 0; settle < KEYPAD_SETTLE_LOOPS; ++settle);
+
+    // pressed keys connect their column to the row, i.e., read 0
+    sample = ~GPIO_ReadInputData(keypad->colGpio) & keypad->colPins;
+
+    if (keypad->pending[row])
+      publishPendingKeys(keypad, row);
+
+    // vertical counters: a key toggles after four consecutive
+    // samples that differ from its stable state
+    delta = sample ^ keypad->stable[row];
+    keypad->count0[row] = ~(keypad->count0[row] & delta);
+    keypad->count1[row] = keypad->count0[row] ^ (keypad->count1[row] & delta);
+    toggle = delta & keypad->count0[row] & keypad->count1[row];
+
+    if (toggle) {
+      keypad->stable[row] ^= toggle;
+      publishRow(keypad, row, toggle);
+    }
+  }
+
+  keypad->rowGpio->BSRR = previous;
+}
+
+static void scanKeypadTask(void *params) {
+  Keypad *keypad = (Keypad*)params;
+  portTickType xLastWakeTime;
+
+  xLastWakeTime = xTaskGetTickCount();
+
+  for (;;) {
+    scanKeypad(keypad);
+	vTaskDelayUntil(&xLastWakeTime, keypad->scanPeriod);
+  }
+}
+
+void setupKeypad(Keypad *keypad) {
+  GPIO_InitTypeDef GPIO_InitStructure;
+  portBASE_TYPE res;
+  u16 pin;
+
+  keypad->numRows = 0;
+  keypad->numCols = 0;
+  for (pin = 0; pin < 16; ++pin) {
+    if (keypad->rowPins & (1 << pin)) {
+      keypad->stable[keypad->numRows] = 0;
+      keypad->count0[keypad->numRows] = 0xFFFF;
+      keypad->count1[keypad->numRows] = 0xFFFF;
+      keypad->pending[keypad->numRows] = 0;
+      keypad->rowSelect[keypad->numRows++] = 1 << pin;
+    }
+    if (keypad->colPins & (1 << pin))
+      keypad->colIndex[pin] = keypad->numCols++;
+  }
+  assert(keypad->numRows > 0 && keypad->numCols > 0);
+  assert(keypad->pressEvents != NULL);
+  keypad->droppedEvents = 0;
+
+  // all rows released (open drain, high)
+  GPIO_InitStructure.GPIO_Pin = keypad->rowPins;
+  GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+  GPIO_InitStructure.GPIO_Mode = GPIO_Mode_Out_OD;
+  GPIO_Init(keypad->rowGpio, &GPIO_InitStructure);
+  keypad->rowGpio->BSRR = keypad->rowPins;
+
+  GPIO_InitStructure.GPIO_Pin = keypad->colPins;
+  GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IPU;
+  GPIO_Init(keypad->colGpio, &GPIO_InitStructure);
+
+  res = xTaskCreateStatic(scanKeypadTask, "keypad",
+                          KEYPAD_STACK_SIZE, (void*)keypad,
+                          keypad->uxPriority, NULL,
+                          keypad->stack, &keypad->taskBuffer);
+  assert(res == pdTRUE);
+}
@@ -0,0 +1,77 @@
+/**
+ * Program skeleton for the course "Programming embedded systems"
+ *
+ * Lab 1: the elevator control system
+ */
+
+/**
+ * Driver for keypad matrices, e.g., the car operating panel of
+ * a building with many floors. Rows are driven low one at a
+ * time, and all columns of a row are read with a single port
+ * access. Keys are debounced bit-parallel and reported as
+ * PinEvents, in the same way as by the pin listeners
+ */
+
+#ifndef KEYPAD_H
+#define KEYPAD_H
+
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "stm32f10x_gpio.h"
+
+#include "global.h"
+
+#define KEYPAD_MAX_ROWS 16
+
+// Stack of the scanning task (words)
+#define KEYPAD_STACK_SIZE 100
+
+// Busy-wait loops after selecting a row, until the column
+// lines have settled
+#ifndef KEYPAD_SETTLE_LOOPS
+#define KEYPAD_SETTLE_LOOPS 8
+#endif
+
+typedef struct {
+  GPIO_TypeDef * rowGpio;             // Port driving the rows (open drain,
+  u16 rowPins;                        // active low), e.g., GPIO_Pin_0 | ...
+  GPIO_TypeDef * colGpio;             // Port reading the columns (pulled
+  u16 colPins;                        // up), e.g., GPIO_Pin_8 | ...
+  const PinEvent *pressEvents;        // Events raised when a key is pressed,
+                                      // rows x columns (in the order of the
+                                      // pins), row by row
+  const PinEvent *releaseEvents;      // Events raised when a key is released,
+                                      // same layout, or NULL
+  portTickType scanPeriod;            // how often the matrix is scanned
+  unsigned portBASE_TYPE uxPriority;  // Priority of the scanning task
+  xQueueHandle pinEventQueue;         // queue where events are sent to
+
+  // internal state (set in "setupKeypad"), one bit per column
+  // pin for each row
+  u8 numRows, numCols;
+  u16 rowSelect[KEYPAD_MAX_ROWS];     // pin of each row
+  u8 colIndex[16];                    // column of each column pin
+  u16 stable[KEYPAD_MAX_ROWS];        // debounced keys (1 = pressed)
+  u16 count0[KEYPAD_MAX_ROWS];        // two-bit vertical counters of
+  u16 count1[KEYPAD_MAX_ROWS];        // the keys differing from "stable"
+  u16 pending[KEYPAD_MAX_ROWS];       // keys whose event did not fit into
+                                      // the queue yet
+  u32 droppedEvents;                  // events coalesced with a pending one
+  xStaticTaskType taskBuffer;         // memory of the scanning task
+  portSTACK_TYPE stack[KEYPAD_STACK_SIZE];
+} Keypad;
+
+/**
+ * Set up a keypad. This initialises the row and column pins
+ * and creates a task that scans the matrix periodically. A key
+ * changes its state after four consecutive scans that differ
+ * from it
+ */
+void setupKeypad(Keypad *keypad);
+
+/**
+ * Scan the whole matrix once (called by the task)
+ */
+void scanKeypad(Keypad *keypad);
+
+#endif
@@ -0,0 +1,82 @@
+/**
+ * Program skeleton for the course "Programming embedded systems"
+ *
+ * Lab 1: the elevator control system
+ */
+
+/**
+ * Latency instrumentation: histograms of how long it takes from
+ * a confirmed input edge until the car starts moving
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+
+#include "latency.h"
+#include "assert.h"
+
+#define LATENCY_STACK_SIZE 120
+
+static LatencyHistogram histograms[LATENCY_STAGES];
+
+static const char *stageNames[LATENCY_STAGES] =
+  { "event->dequeue", "dequeue->target", "target->motor" };
+
+static portTickType reportPeriod;
+
+static xStaticTaskType monitorTaskBuffer;
+static portSTACK_TYPE monitorStack[LATENCY_STACK_SIZE];
+
+void recordLatency(LatencyStage stage, portTickType ticks) {
+  LatencyHistogram *histogram = histograms + stage;
+  u32 ms = ticks * portTICK_RATE_MS;
+  u8 bucket = 0;
+
+  while (bucket < LATENCY_BUCKETS - 1 && ms >= ((u32)1 << bucket))
+    bucket++;
+
+  histogram->buckets[bucket]++;
+  histogram->count++;
+  if (ticks > histogram->max)
+    histogram->max = ticks;
+}
+
+const LatencyHistogram *getLatencyHistogram(LatencyStage stage) {
+  return histograms + stage;
+}
+
+void printLatencyHistograms(void) {
+  u8 stage, bucket;
+
+  for (stage = 0; stage < LATENCY_STAGES; ++stage) {
+    printf("latency %s: %lu samples, max %lu ms, <2^i ms:",
+           stageNames[stage], histograms[stage].count,
+           histograms[stage].max * portTICK_RATE_MS);
+    for (bucket = 0; bucket < LATENCY_BUCKETS; ++bucket)
+      printf(" %lu", histograms[stage].buckets[bucket]);
+    printf("\n");
+  }
+}
+
+static void latencyMonitorTask(void *params) {
+  portTickType xLastWakeTime;
+
+  xLastWakeTime = xTaskGetTickCount();
+
+  for (;;) {
+    vTaskDelayUntil(&xLastWakeTime, reportPeriod);
+    printLatencyHistograms();
+  }
+}
+
+void setupLatencyMonitor(portTickType period,
+                         unsigned portBASE_TYPE uxPriority) {
+  portBASE_TYPE res;
+
+  reportPeriod = period;
+  res = xTaskCreateStatic(latencyMonitorTask, "latency",
+                          LATENCY_STACK_SIZE, NULL, uxPriority, NULL,
+                          monitorStack, &monitorTaskBuffer);
+  assert(res == pdTRUE);
+}
@@ -0,0 +1,52 @@
+/**
+ * Program skeleton for the course "Programming embedded systems"
+ *
+ * Lab 1: the elevator control system
+ */
+
+/**
+ * Latency instrumentation: histograms of how long it takes from
+ * a confirmed input edge until the car starts moving
+ */
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include "FreeRTOS.h"
+#include "stm32f10x_type.h"
+
+typedef enum {
+  LATENCY_EVENT_TO_DEQUEUE = 0,   // edge confirmed -> planner dequeues it
+  LATENCY_DEQUEUE_TO_TARGET,      // request dequeued -> target position set
+  LATENCY_TARGET_TO_MOTOR,        // target position set -> motor starts
+  LATENCY_STAGES
+} LatencyStage;
+
+// Bucket i counts latencies below 2^i ms (and above the previous
+// bucket); the last bucket counts everything above
+#define LATENCY_BUCKETS 12
+
+typedef struct {
+  u32 buckets[LATENCY_BUCKETS];
+  u32 count;
+  portTickType max;
+} LatencyHistogram;
+
+/**
+ * Record one latency sample (unit is ticks). Only to be called
+ * from a single task
+ */
+void recordLatency(LatencyStage stage, portTickType ticks);
+
+const LatencyHistogram *getLatencyHistogram(LatencyStage stage);
+
+// Print all histograms to the serial port
+void printLatencyHistograms(void);
+
+/**
+ * Create a task that periodically prints the histograms
+ */
+void setupLatencyMonitor(portTickType period,
+                         unsigned portBASE_TYPE uxPriority);
+
+#endif
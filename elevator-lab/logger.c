@@ -0,0 +1,147 @@
+/**
+ * Program skeleton for the course "Programming embedded systems"
+ *
+ * Lab 1: the elevator control system
+ */
+
+/**
+ * Deferred logging through a lock-free ring
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+
+#include "logger.h"
+#include "assert.h"
+
+#define LOGGER_STACK_SIZE 120
+
+/**
+ * Bounded multi-producer queue: a slot is free for the writer of
+ * position p when its sequence is p, and holds a record for the
+ * reader when its sequence is p + 1. Writers claim positions by
+ * compare-and-swap on "head"; only the drain task reads. A writer
+ * that finds a sequence behind p has found the ring full; one
+ * ahead of p means that another writer has claimed p in the
+ * meantime, and "head" is read again
+ */
+typedef struct {
+  vu32 sequence;
+  portTickType tick;
+  const char *format;
+  u32 args[3];
+} LogRecord;
+
+static LogRecord ring[LOG_SIZE];
+static vu32 head = 0;           // next position to be claimed by a writer
+static u32 tail = 0;            // next position to be read
+static vu32 dropped = 0;
+
+static portTickType drainPeriod;
+
+static xStaticTaskType loggerTaskBuffer;
+static portSTACK_TYPE loggerStack[LOGGER_STACK_SIZE];
+
+// keep the compiler from moving accesses to a record across
+// the update of its sequence (the core itself does not reorder)
+#ifdef __CC_ARM
+#define COMPILER_BARRIER() __schedule_barrier()
+#else
+#define COMPILER_BARRIER() __asm__ volatile ("" ::: "memory")
+#endif
+
+static bool compareAndSwap(vu32 *addr, u32 expected, u32 desired) {
+#ifdef __CC_ARM
+  if (__ldrex(addr) != expected) {
+    __clrex();
+    return FALSE;
+  }
+  return __strex(desired, addr) == 0;
+#else
+  return __sync_bool_compare_and_swap(addr, expected, desired);
+#endif
+}
+
+void logMessage(const char *format, u32 arg0, u32 arg1, u32 arg2) {
+  LogRecord *record;
+  u32 pos;
+  s32 diff;
+
+  for (;;) {
+    pos = head;
+    record = ring + (pos & (LOG_SIZE - 1));
+    diff = (s32)(record->sequence - pos);
+
+    if (diff == 0) {
+      if (compareAndSwap(&head, pos, pos + 1))
+        break;
+    } else if (diff < 0) {
+      // not yet drained: the ring is full
+      do {
+        pos = dropped;
+      } while (!compareAndSwap(&dropped, pos, pos + 1));
+      return;
+    }
+  }
+
+  record->tick = xTaskGetTickCount();
+  record->format = format;
+  record->args[0] = arg0;
+  record->args[1] = arg1;
+  record->args[2] = arg2;
+  // publish the record
+  COMPILER_BARRIER();
+  record->sequence = pos + 1;
+}
+
+u32 getLogDropped(void) {
+  return dropped;
+}
+
+static void loggerTask(void *params) {
+  portTickType xLastWakeTime;
+  LogRecord *record;
+  u32 reported = 0;
+
+  xLastWakeTime = xTaskGetTickCount();
+
+  for (;;) {
+    record = ring + (tail & (LOG_SIZE - 1));
+
+    while (record->sequence == tail + 1) {
+      COMPILER_BARRIER();
+      printf("[%lu] ", record->tick * portTICK_RATE_MS);
+      printf(record->format, record->args[0], record->args[1], record->args[2]);
+
+      // hand the slot back to the writers
+      COMPILER_BARRIER();
+      record->sequence = tail + LOG_SIZE;
+      tail++;
+      record = ring + (tail & (LOG_SIZE - 1));
+    }
+
+    if (dropped != reported) {
+      reported = dropped;
+      printf("log: %lu records dropped\n", reported);
+    }
+
+    vTaskDelayUntil(&xLastWakeTime, drainPeriod);
+  }
+}
+
+void setupLogger(portTickType period, unsigned portBASE_TYPE uxPriority) {
+  portBASE_TYPE res;
+  u32 i;
+
+  assert((LOG_SIZE & (LOG_SIZE - 1)) == 0);
+
+  for (i = 0; i < LOG_SIZE; ++i)
+    ring[i].sequence = i;
+  drainPeriod = period;
+
+  res = xTaskCreateStatic(loggerTask, "logger",
+                          LOGGER_STACK_SIZE, NULL, uxPriority, NULL,
+                          loggerStack, &loggerTaskBuffer);
+  assert(res == pdTRUE);
+}
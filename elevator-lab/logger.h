@@ -0,0 +1,42 @@
+/**
+ * Program skeleton for the course "Programming embedded systems"
+ *
+ * Lab 1: the elevator control system
+ */
+
+/**
+ * Deferred logging. Tasks write binary records into a lock-free
+ * ring in constant time, without ever blocking; a low-priority
+ * task formats them and sends them to the serial port
+ */
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include "FreeRTOS.h"
+#include "stm32f10x_type.h"
+
+// number of records in the ring (a power of 2)
+#define LOG_SIZE 32
+
+/**
+ * Log a message; "format" is a printf format with at most three
+ * arguments, each of which has to fit into 32 bits. The format
+ * and string arguments have to stay valid (e.g., be literals),
+ * since they are only read when the record is drained. If the
+ * ring is full, the record is dropped and counted. Not to be
+ * called from interrupts
+ */
+void logMessage(const char *format, u32 arg0, u32 arg1, u32 arg2);
+
+/**
+ * Number of records dropped because the ring was full
+ */
+u32 getLogDropped(void);
+
+/**
+ * Create the task draining the ring every "period" ticks
+ */
+void setupLogger(portTickType period, unsigned portBASE_TYPE uxPriority);
+
+#endif
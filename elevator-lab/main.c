@@ -27,32 +27,46 @@
 #include "motor.h"
 #include "planner.h"
 #include "safety.h"
+#include "latency.h"
+#include "watchdog.h"
+#include "journal.h"
+#include "logger.h"
+#include "cpu_usage.h"
+#include "stack_monitor.h"
 
 #include "assert.h"
 
 /*-----------------------------------------------------------*/
 /* Input module */
 
+#define PIN_EVENT_QUEUE_LENGTH 32
+
 xQueueHandle pinEventQueue;
 
+static xStaticQueueType pinEventQueueBuffer;
+static u8 pinEventQueueStorage[PIN_EVENT_QUEUE_LENGTH * sizeof(TimedPinEvent)];
+
 /**
  * This array describes which pins are connected to which
- * events
+ * events, and how they are debounced. Listeners on the same
+ * port have to be next to each other
  */
 PinListener pinListeners[] =
-   { { GPIOC, GPIO_Pin_0, TO_FLOOR_1,       UNASSIGNED },
-     { GPIOC, GPIO_Pin_1, TO_FLOOR_2,       UNASSIGNED },
-     { GPIOC, GPIO_Pin_2, TO_FLOOR_3,       UNASSIGNED },
-     { GPIOC, GPIO_Pin_3, STOP_PRESSED,     STOP_RELEASED },
-     { GPIOC, GPIO_Pin_7, ARRIVED_AT_FLOOR, LEFT_FLOOR },
-     { GPIOC, GPIO_Pin_8, DOORS_CLOSED,     DOORS_OPENING } };
+   { { GPIOC, GPIO_Pin_0, TO_FLOOR_1,       UNASSIGNED,    &debounceButton },
+     { GPIOC, GPIO_Pin_1, TO_FLOOR_2,       UNASSIGNED,    &debounceButton },
+     { GPIOC, GPIO_Pin_2, TO_FLOOR_3,       UNASSIGNED,    &debounceButton },
+     { GPIOC, GPIO_Pin_3, STOP_PRESSED,     STOP_RELEASED, &debounceButton },
+     { GPIOC, GPIO_Pin_7, ARRIVED_AT_FLOOR, LEFT_FLOOR,    &debounceNone },
+     { GPIOC, GPIO_Pin_8, DOORS_CLOSED,     DOORS_OPENING, &debounceNone } };
 
 PinListenerSet listenerSet = {
    pinListeners,            // Array connecting pins with events
    6,						// size of the array
    10 / portTICK_RATE_MS,	// Rate at which the status of pins is checked
    1,                       // Priority
-   NULL };					// Event queue (set in "setupInputModule")
+   NULL,					// Event queue (set in "setupInputModule")
+   TRUE,					// Wait for pin changes instead of polling
+   1 };						// Samples per period (no DMA sampling)
 
 
 /**
@@ -66,13 +80,14 @@ PositionTracker carPositionTracker;
 void setupInputModule() {
   GPIO_InitTypeDef GPIO_InitStructure;
 
-  pinEventQueue = xQueueCreate(32, sizeof(PinEvent));
+  pinEventQueue = xQueueCreateStatic(PIN_EVENT_QUEUE_LENGTH, sizeof(TimedPinEvent),
+                                     pinEventQueueStorage, &pinEventQueueBuffer);
   assert(pinEventQueue != NULL);
   listenerSet.pinEventQueue = pinEventQueue;
 
-  // Initialise pins 0, 1, 2, 3, 7, 8, 9 of GPIOC for input
-  GPIO_InitStructure.GPIO_Pin = GPIO_Pin_0 | GPIO_Pin_1 | GPIO_Pin_2 | GPIO_Pin_3 | 
-                                GPIO_Pin_7 | GPIO_Pin_8 | GPIO_Pin_9;
+  // Initialise pin 9 of GPIOC (position pulses) for input; the
+  // pins of the listeners are initialised by "setupPinListeners"
+  GPIO_InitStructure.GPIO_Pin = GPIO_Pin_9;
   GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IN_FLOATING;
   GPIO_Init( GPIOC, &GPIO_InitStructure );
 
@@ -132,6 +147,10 @@ s32 getCarPosition() {
   return getPosition(&carPositionTracker);
 }
 
+u32 getCarPulseHistory(s32 *position, portTickType *ticks) {
+  return getPulseHistory(&carPositionTracker, position, ticks);
+}
+
 s32 getCarTargetPosition(void) {
   return getTargetPosition(&carMotor);
 }
@@ -140,6 +159,10 @@ void setCarTargetPosition(s32 target) {
   setTargetPosition(&carMotor, target);
 }
 
+s32 getCarSpeed(void) {
+  return getSpeed(&carMotor);
+}
+
 void setCarMotorStopped(u8 stopped) {
   setMotorStopped(&carMotor, stopped);
 }
@@ -149,16 +172,8 @@ Direction getCarDirection() {
 }
 
 bool checkInputsStabilized() {
-	u8 i;
-
-
-	for (i = 0; i < listenerSet.num; i++)	{
-		if ((listenerSet.listeners + i)->status == INPUT_UNSTABLE) {
-			return FALSE;
-		}
-	}
-
-	return TRUE;
+	//pins that violated env4 are flagged by the pin listener
+	return pinListenersStable(&listenerSet);
 }
 
 s32 getPlannerTargetPosition() {
@@ -196,7 +211,16 @@ int main( void )
   setupInputModule();
   setupActuatorModule();
   setupPlanner(1);
+  setupJournal();
   setupSafety(3);
+  setupLogger(20 / portTICK_RATE_MS, 0);
+  setupLatencyMonitor(60000 / portTICK_RATE_MS, 0);
+  setupSafetyReport(60000 / portTICK_RATE_MS, 0);
+  setupCpuUsageReport(10000 / portTICK_RATE_MS, 0);
+  setupStackReport(60000 / portTICK_RATE_MS, 0);
+  // supervise the tasks registered above; a hanging task causes
+  // a reset within 250 ms
+  setupWatchdog(250, 50 / portTICK_RATE_MS, 4);
 
   printf("Setup completed\n");  // this is redirected to USART 1
 
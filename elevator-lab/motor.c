@@ -17,6 +17,7 @@
 
 #include "position_tracker.h"
 #include "motor.h"
+#include "watchdog.h"
 
 #include "assert.h"
 
@@ -67,6 +68,7 @@ static setCompare(TIM_TypeDef* TIMx, u16 channel, u16 value) {
 }
 
 static void setDuty(Motor *motor, s32 duty) {
+  motor->duty = duty;
   if (duty < 0) {
     setCompare(motor->TIMx, motor->upChannel, 0);
     setCompare(motor->TIMx, motor->downChannel, (u16)-duty);
@@ -129,6 +131,7 @@ static void motorTask(void *params) {
       setDuty(motor, currentDuty);
 	}
 
+	heartbeat(motor->heartbeat);
 	vTaskDelayUntil(&xLastWakeTime, motor->pollingPeriod);
   }
 }
@@ -146,12 +149,14 @@ void setupMotor(Motor *motor,
   motor->currentPosition = currentPosition;
   motor->targetPosition = 0;
   motor->stopped = 0;
-  motor->lock = xSemaphoreCreateMutex();
+  motor->lock = xSemaphoreCreateMutexStatic(&motor->lockBuffer);
   assert(motor->lock != NULL);
   motor->TIMx = TIMx;
   motor->upChannel = upChannel;
   motor->downChannel = downChannel;
+  motor->duty = 0;
   motor->pollingPeriod = pollingPeriod;
+  motor->heartbeat = registerHeartbeat("motor", 5 * pollingPeriod);
 
   // Setup two timer channels for PWM output
   TIM_OCStructInit(&TIM_OCInitStruct);
@@ -165,8 +170,9 @@ void setupMotor(Motor *motor,
   TIM_OCInitStruct.TIM_Channel = downChannel;
   TIM_OCInit(TIMx, &TIM_OCInitStruct);
 
-  res = xTaskCreate(motorTask, "motor", 80,
-                   (void*)motor, uxPriority, NULL);
+  res = xTaskCreateStatic(motorTask, "motor", MOTOR_STACK_SIZE,
+                         (void*)motor, uxPriority, NULL,
+                         motor->stack, &motor->taskBuffer);
   assert(res == pdTRUE);
 }
 
@@ -182,6 +188,10 @@ s32 getTargetPosition(Motor *motor) {
   //xSemaphoreGive(motor->lock);
 }
 
+s32 getSpeed(Motor *motor) {
+  return motor->duty / DUTY_FACTOR;
+}
+
 void setMotorStopped(Motor *motor, u8 stopped) {
   xSemaphoreTake(motor->lock, portMAX_DELAY);
   motor->stopped = stopped;
@@ -18,6 +18,9 @@
 
 #include "position_tracker.h"
 
+// Stack of the motor task (words)
+#define MOTOR_STACK_SIZE 80
+
 typedef struct {
 
   vs32 targetPosition;				// Position that we currently are
@@ -34,9 +37,18 @@ typedef struct {
   TIM_TypeDef* TIMx;                // Timer and channels used for PWM
   u16 upChannel, downChannel;
 
+  vs32 duty;                        // Duty currently applied to the motor;
+                                    // positive upwards, negative downwards
+
   portTickType pollingPeriod;       // Period at which current and target
                                     // position are compared
 
+  u8 heartbeat;                     // id of the task at the watchdog
+
+  xStaticQueueType lockBuffer;      // memory of the lock and of the
+  xStaticTaskType taskBuffer;       // motor task
+  portSTACK_TYPE stack[MOTOR_STACK_SIZE];
+
 } Motor;
 
 void setupMotor(Motor *motor,
@@ -49,6 +61,10 @@ void setupMotor(Motor *motor,
 void setTargetPosition(Motor *motor, s32 target);
 s32 getTargetPosition(Motor *motor);
 
+// Current speed of the car in cm/s, derived from the applied duty
+// (positive upwards, negative downwards)
+s32 getSpeed(Motor *motor);
+
 // Stop motor immediately (usually due to safety reasons)
 void setMotorStopped(Motor *motor, u8 stopped);
 
@@ -11,151 +11,445 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "stm32f10x_gpio.h"
+#include "stm32f10x_exti.h"
+#include "stm32f10x_nvic.h"
+#include "stm32f10x_rcc.h"
+#include "stm32f10x_tim.h"
+#include "stm32f10x_dma.h"
 
 #include "pin_listener.h"
 #include "assert.h"
 
-#define GPIO_CALL_BUTTON 	(GPIO_Pin_0 | GPIO_Pin_1 | GPIO_Pin_2)
-#define GPIO_STOP_BUTTON 	GPIO_Pin_3
-
-static void pollPin(PinListener *listener,
-                    xQueueHandle pinEventQueue) {
-
-  u8 data;
-
-  //read GPIO Pin every 10 ms
-  data = GPIO_ReadInputDataBit( listener->gpio, listener->pin );
-
-	if (listener->pin & (GPIO_CALL_BUTTON | GPIO_STOP_BUTTON))	{
-	  //debounce only for buttons
-		switch (listener->status) {
-	    case RELEASED: // released
-	      if( data == 1 ) {
-					listener->status++;        
-				}
-	      break;
-	    case (RELEASED + 1): // first down
-	      if( data == 1 ) {
-					listener->status++;        
-				}	else {
-					listener->status = BOUNCED_RELEASED;	 //bounced while released
-				}
-	      break;
-	    case (RELEASED + 2): // second down
-	      if( data == 1 ) {
-					listener->status = PRESSED; //pressed
-					xQueueSend(pinEventQueue, &listener->risingEvent, portMAX_DELAY);        
-				}	else {
-					listener->status = INPUT_UNSTABLE; //env 4 violated
-				}
-	      break;
-	    case BOUNCED_RELEASED: // bounced while released first down
-	      if( data == 1 ) {
-					listener->status++;         
-				}	else {
-					listener->status = INPUT_UNSTABLE; //env 4 violated
-				}
-	      break;
-	    case (BOUNCED_RELEASED + 1): // bounced while released second down
-	      if( data == 1 ) {
-					listener->status = PRESSED; //pressed
-					xQueueSend(pinEventQueue, &listener->risingEvent, portMAX_DELAY);        
-				}	else {
-					listener->status = INPUT_UNSTABLE; //env 4 violated
-				}
-	      break;	
-	
-	    case PRESSED: // pressed
-	      if( data == 0 ) {
-					listener->status++;        
-				}
-	      break;
-	    case (PRESSED + 1): // first up
-	      if( data == 0 ) {
-					listener->status++;        
-				}	else {
-					listener->status = BOUNCED_PRESSED;	 //debounced while pressed
-				}
-	      break;
-	    case (PRESSED + 2): // second up
-	      if( data == 0 ) {
-					listener->status = RELEASED; //released
-					if (!(listener->pin & GPIO_CALL_BUTTON))	{// ignore falling edge event for the inputs from buttons
-						xQueueSend(pinEventQueue, &listener->fallingEvent, portMAX_DELAY); 
-					}         
-				}	else {
-					listener->status = INPUT_UNSTABLE; //env 4 violated
-				}
-	      break;
-	    case BOUNCED_PRESSED: // bounced while pressed first up
-	      if( data == 0 ) {
-					listener->status++;         
-				}	else {
-					listener->status = INPUT_UNSTABLE; //env 4 violated
-				}
-	      break;
-	    case (BOUNCED_PRESSED + 1): // bounced while pressed second up
-	      if( data == 0 ) {
-					listener->status = RELEASED; //released
-					if (!(listener->pin & GPIO_CALL_BUTTON))	{// ignore falling edge event for the inputs from buttons
-						xQueueSend(pinEventQueue, &listener->fallingEvent, portMAX_DELAY); 
-					}        
-				}	else {
-					listener->status = INPUT_UNSTABLE; //env 4 violated
-				}
-	      break;		
-	
-			case INPUT_UNSTABLE: //input behaved incorrectly - will be noticed by the Safety module
-				//do nothing
-				break;
-	
-	    default:
-	      break;
-	
-	  }
-	} else {
-		switch (listener->status) {
-	    case (RELEASED): 
-	      if( data == 1 ) {	//rising edge
-					listener->status = PRESSED; //pressed
-					xQueueSend(pinEventQueue, &listener->risingEvent, portMAX_DELAY);        
-				}
-	      break;
-	    case (PRESSED): 
-	      if( data == 0 ) {	//falling edge
-					listener->status = RELEASED; //released
-					if (!(listener->pin & GPIO_CALL_BUTTON))	{// ignore falling edge event for the inputs from buttons
-						xQueueSend(pinEventQueue, &listener->fallingEvent, portMAX_DELAY); 
-					}       
-				}
-	      break;			
-		default:
-	      break;
-		}
-	}
+DebounceTable debounceButton = DEBOUNCE_TABLE(2, 3);
+DebounceTable debounceNone = DEBOUNCE_TABLE(0, 0);
 
+// set woken up by the EXTI interrupt handlers, and its EXTI lines
+static PinListenerSet *interruptSet = NULL;
+static u16 interruptLines = 0;
+
+// circular buffer the port is sampled into by DMA (channel 2 is
+// triggered by the update event of TIM2), and the next sample
+// to be processed
+#define PIN_SAMPLE_BUFFER 64
+static vu16 dmaSamples[PIN_SAMPLE_BUFFER];
+static u16 dmaReadIndex = 0;
+static PinListenerSet *dmaSet = NULL;
+
+/**
+ * Events are published without blocking, so that sampling never
+ * stalls when the consumer does. An event that does not fit into
+ * the queue is kept with its listener and retried, in order, in
+ * the next cycles. A rising event (a press of the stop button) is
+ * never given up: a falling edge after it is kept as well, while
+ * a rising edge after a pending falling one cancels it, as the
+ * consumer then still has the current level. A button request
+ * that is still pending absorbs further presses. Edges that are
+ * never reported this way are counted
+ */
+static void publishEvent(PinListenerSet *set, PinPort *port,
+                         PinListener *listener) {
+  TimedPinEvent ev;
+  u8 *num = &listener->numPending;
+
+  ev.event = (port->stable & listener->pin) ? listener->risingEvent
+                                            : listener->fallingEvent;
+  ev.tick = listener->confirmed;
+
+  if (*num == 0) {
+    if (xQueueSend(set->pinEventQueue, &ev, 0) != pdTRUE) {
+      listener->pending[(*num)++] = ev;
+      port->pendingPins |= listener->pin;
+    }
+  } else if (ev.event == listener->pending[*num - 1].event) {
+    // another request of a button without a falling event
+    set->droppedEvents++;
+  } else if (ev.event == listener->fallingEvent) {
+    listener->pending[(*num)++] = ev;
+  } else {
+    // rising edge after a pending falling one
+    set->droppedEvents += 2;
+    if (--*num == 0)
+      port->pendingPins &= ~listener->pin;
+  }
+}
+
+static void publishPendingEvents(PinListenerSet *set, PinPort *port) {
+  int i;
+
+  for (i = 0; i < port->num && port->pendingPins; ++i) {
+    PinListener *listener = port->listeners + i;
+
+    while (listener->numPending) {
+      if (xQueueSend(set->pinEventQueue, listener->pending, 0) != pdTRUE)
+        return;
+      listener->pending[0] = listener->pending[1];
+      if (--listener->numPending == 0)
+        port->pendingPins &= ~listener->pin;
+    }
+  }
+}
+
+/**
+ * Process one sample of all pins of a port; only pins that
+ * differ from their stable value or are still being debounced
+ * are stepped through their transition table. A transition
+ * starts at the first differing sample and is then stepped
+ * once per polling period, so that the tables keep their
+ * meaning however often the port is sampled. A pin that
+ * violates env4 is frozen; this is noticed by the Safety
+ * module
+ */
+static void samplePort(PinListenerSet *set, PinPort *port,
+                       u16 sample, portTickType tick) {
+  u16 differs, active;
+  u8 next;
+  int i;
+
+  differs = sample ^ port->stable;
+  active = (differs | port->transient) & ~port->unstable;
+
+  if (!active)
+    return;
+
+  for (i = 0; i < port->num; ++i) {
+    PinListener *listener = port->listeners + i;
+
+    if (!(listener->pin & active))
+      continue;
+
+    // in the middle of a polling period
+    if (listener->state && --listener->phase)
+      continue;
+    listener->phase = set->samplesPerPoll;
+
+    next = (*listener->debounce)[listener->state][(differs & listener->pin) != 0];
+
+    if (next == DEBOUNCE_ACCEPT) {
+      listener->state = 0;
+      port->transient &= ~listener->pin;
+      port->stable ^= listener->pin;
+      listener->confirmed = tick;
+
+      // no falling edge event for the inputs from buttons
+      if ((port->stable & listener->pin) || listener->fallingEvent != UNASSIGNED)
+        publishEvent(set, port, listener);
+    } else if (next == DEBOUNCE_UNSTABLE) {
+      //env 4 violated
+      port->transient &= ~listener->pin;
+      port->unstable |= listener->pin;
+    } else {
+      listener->state = next;
+      if (next)
+        port->transient |= listener->pin;
+      else
+        port->transient &= ~listener->pin;
+    }
+  }
+}
+
+// All pins of a port are sampled with a single read
+static void pollPort(PinListenerSet *set, PinPort *port) {
+  if (port->pendingPins)
+    publishPendingEvents(set, port);
+
+  //read all pins of the port every 10 ms
+  samplePort(set, port, GPIO_ReadInputData(port->gpio), xTaskGetTickCount());
+}
+
+/**
+ * Process the samples the DMA has written since the last
+ * call; each accepted edge is stamped with the time of the
+ * sample it was detected in
+ */
+static void processSamples(PinListenerSet *set) {
+  PinPort *port = set->ports;
+  u16 writeIndex, remaining;
+  u32 sampleMs = set->pollingPeriod * portTICK_RATE_MS;
+  portTickType now;
+
+  if (port->pendingPins)
+    publishPendingEvents(set, port);
+
+  now = xTaskGetTickCount();
+  writeIndex = PIN_SAMPLE_BUFFER - DMA_GetCurrDataCounter(DMA_Channel2);
+  if (writeIndex == PIN_SAMPLE_BUFFER)
+    writeIndex = 0;
+  remaining = (writeIndex + PIN_SAMPLE_BUFFER - dmaReadIndex) % PIN_SAMPLE_BUFFER;
+
+  while (remaining--) {
+    samplePort(set, port, dmaSamples[dmaReadIndex],
+               now - remaining * sampleMs / set->samplesPerPoll / portTICK_RATE_MS);
+    if (++dmaReadIndex == PIN_SAMPLE_BUFFER)
+      dmaReadIndex = 0;
+  }
+}
+
+/**
+ * After sleeping in interrupt-driven mode, the buffer may have
+ * been overwritten many times; all samples taken while asleep
+ * are quiet, except the most recent ones, which contain the
+ * edge that woke the task up
+ */
+static void resyncSamples(PinListenerSet *set, portTickType sleptAt) {
+  u32 elapsed = (xTaskGetTickCount() - sleptAt) * set->samplesPerPoll /
+                set->pollingPeriod;
+  u16 writeIndex;
+
+  if (elapsed < PIN_SAMPLE_BUFFER - set->samplesPerPoll)
+    return;
+
+  writeIndex = PIN_SAMPLE_BUFFER - DMA_GetCurrDataCounter(DMA_Channel2);
+  dmaReadIndex = (writeIndex + PIN_SAMPLE_BUFFER - set->samplesPerPoll) %
+                 PIN_SAMPLE_BUFFER;
+}
+
+// check whether any pin is being debounced or has an event pending
+static bool pinsBusy(PinListenerSet *set) {
+  int i;
+
+  for (i = 0; i < set->numPorts; ++i) {
+    if (set->ports[i].transient | set->ports[i].pendingPins)
+      return TRUE;
+  }
+  return FALSE;
 }
 
 static void pollPinsTask(void *params) {
-  PinListenerSet listeners = *((PinListenerSet*)params);
+  PinListenerSet *listeners = (PinListenerSet*)params;
   portTickType xLastWakeTime;
   int i;
 
   xLastWakeTime = xTaskGetTickCount();
 
   for (;;) {
-    for (i = 0; i < listeners.num; ++i)
-	  pollPin(listeners.listeners + i, listeners.pinEventQueue);
+    if (listeners == dmaSet) {
+      processSamples(listeners);
+    } else {
+      for (i = 0; i < listeners->numPorts; ++i)
+        pollPort(listeners, listeners->ports + i);
+    }
+
+    if (listeners->interruptDriven && !pinsBusy(listeners)) {
+      // all pins have settled: nothing to do until the next edge,
+      // which is then sampled immediately (or, with DMA sampling,
+      // after the samples following it have been taken)
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      if (listeners == dmaSet) {
+        resyncSamples(listeners, xLastWakeTime);
+        xLastWakeTime = xTaskGetTickCount();
+        vTaskDelayUntil(&xLastWakeTime, listeners->pollingPeriod);
+      } else {
+        xLastWakeTime = xTaskGetTickCount();
+      }
+      continue;
+    }
     
-	vTaskDelayUntil(&xLastWakeTime, listeners.pollingPeriod);
+	vTaskDelayUntil(&xLastWakeTime, listeners->pollingPeriod);
   }
 }
 
+static u16 portPins(PinPort *port) {
+  u16 pins = 0;
+  int i;
+
+  for (i = 0; i < port->num; ++i)
+    pins |= port->listeners[i].pin;
+  return pins;
+}
+
+static void setupPinInterrupts(PinListenerSet *listenerSet) {
+  EXTI_InitTypeDef EXTI_InitStructure;
+  NVIC_InitTypeDef NVIC_InitStructure;
+  u16 pins;
+  u8 pin;
+  int i;
+
+  assert(interruptSet == NULL);
+  interruptSet = listenerSet;
+
+  // the interrupt handlers notify the polling task directly
+  assert(listenerSet->task != NULL);
+
+  // connect the EXTI lines to the ports of the listeners; each
+  // line can only be connected to one port
+  for (i = 0; i < listenerSet->numPorts; ++i) {
+    pins = portPins(listenerSet->ports + i);
+    assert(!(pins & interruptLines));
+    interruptLines |= pins;
+
+    for (pin = 0; pin < 16; ++pin) {
+      if (pins & (1 << pin))
+        GPIO_EXTILineConfig((u8)(((u32)listenerSet->ports[i].gpio - GPIOA_BASE) / 0x400),
+                            pin);
+    }
+  }
+  pins = interruptLines;
+
+  EXTI_InitStructure.EXTI_Line = pins;
+  EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
+  EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Rising_Falling;
+  EXTI_InitStructure.EXTI_LineCmd = ENABLE;
+  EXTI_Init(&EXTI_InitStructure);
+  EXTI_ClearITPendingBit(pins);
+
+  NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = configLIBRARY_KERNEL_INTERRUPT_PRIORITY;
+  NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+  NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+  for (pin = 0; pin < 16; ++pin) {
+    if (!(pins & (1 << pin)))
+      continue;
+    if (pin <= 4)
+      NVIC_InitStructure.NVIC_IRQChannel = EXTI0_IRQChannel + pin;
+    else if (pin <= 9)
+      NVIC_InitStructure.NVIC_IRQChannel = EXTI9_5_IRQChannel;
+    else
+      NVIC_InitStructure.NVIC_IRQChannel = EXTI15_10_IRQChannel;
+    NVIC_Init(&NVIC_InitStructure);
+  }
+}
+
+static void pinChangedFromISR(void) {
+  portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+  EXTI_ClearITPendingBit(interruptLines);
+
+  vTaskNotifyGiveFromISR(interruptSet->task, &xHigherPriorityTaskWoken);
+  portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+}
+
+/**
+ * TIM2 requests a DMA transfer of the input data register of
+ * the port into the circular buffer at every update event, i.e.,
+ * "samplesPerPoll" times per polling period
+ */
+static void setupSampleDMA(PinListenerSet *listenerSet) {
+  DMA_InitTypeDef DMA_InitStructure;
+  TIM_TimeBaseInitTypeDef timInit;
+  u32 periodUs;
+
+  assert(dmaSet == NULL);
+  assert(listenerSet->numPorts == 1);
+  assert(listenerSet->samplesPerPoll <= PIN_SAMPLE_BUFFER / 2);
+  dmaSet = listenerSet;
+
+  periodUs = listenerSet->pollingPeriod * portTICK_RATE_MS * 1000 /
+             listenerSet->samplesPerPoll;
+  assert(periodUs > 0 && periodUs <= 0x10000);
+
+  RCC_AHBPeriphClockCmd( RCC_AHBPeriph_DMA, ENABLE );
+  RCC_APB1PeriphClockCmd( RCC_APB1Periph_TIM2, ENABLE );
+
+  DMA_DeInit(DMA_Channel2);
+  DMA_InitStructure.DMA_PeripheralBaseAddr = (u32)&listenerSet->ports[0].gpio->IDR;
+  DMA_InitStructure.DMA_MemoryBaseAddr = (u32)dmaSamples;
+  DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+  DMA_InitStructure.DMA_BufferSize = PIN_SAMPLE_BUFFER;
+  DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+  DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+  DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
+  DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
+  DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+  DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+  DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+  DMA_Init(DMA_Channel2, &DMA_InitStructure);
+
+  // samples taken before the task runs the first time are
+  // compared with the initial (low) stable values
+  dmaReadIndex = 0;
+  DMA_Cmd(DMA_Channel2, ENABLE);
+
+  TIM_DeInit( TIM2 );
+  TIM_TimeBaseStructInit( &timInit );
+
+  timInit.TIM_Period = (u16)(periodUs - 1);        // Auto-reload period
+  timInit.TIM_Prescaler = 71;                      // Prescaler; resulting frequency
+                                                   //  is 72MHz / 72 = 1MHz
+  timInit.TIM_ClockDivision = TIM_CKD_DIV1;        // Clock division 1
+  timInit.TIM_CounterMode = TIM_CounterMode_Up;    // Counting upwards
+
+  TIM_TimeBaseInit( TIM2, &timInit );
+  TIM_DMACmd( TIM2, TIM_DMA_Update, ENABLE );
+  TIM_Cmd( TIM2, ENABLE );
+}
+
+void EXTI0_IRQHandler(void)     { pinChangedFromISR(); }
+void EXTI1_IRQHandler(void)     { pinChangedFromISR(); }
+void EXTI2_IRQHandler(void)     { pinChangedFromISR(); }
+void EXTI3_IRQHandler(void)     { pinChangedFromISR(); }
+void EXTI4_IRQHandler(void)     { pinChangedFromISR(); }
+void EXTI9_5_IRQHandler(void)   { pinChangedFromISR(); }
+void EXTI15_10_IRQHandler(void) { pinChangedFromISR(); }
+
+bool pinListenersStable(PinListenerSet *listenerSet) {
+  int i;
+
+  for (i = 0; i < listenerSet->numPorts; ++i) {
+    if (listenerSet->ports[i].unstable)
+      return FALSE;
+  }
+  return TRUE;
+}
+
 void setupPinListeners(PinListenerSet *listenerSet) {
+  GPIO_InitTypeDef GPIO_InitStructure;
+  PinPort *port = NULL;
   portBASE_TYPE res;
+  int i;
+
+  // group the listeners by port, so that each port is read
+  // only once per cycle
+  listenerSet->numPorts = 0;
+  for (i = 0; i < listenerSet->num; ++i) {
+    PinListener *listener = listenerSet->listeners + i;
+
+    assert(listener->debounce != NULL);
+    listener->state = 0;
+    listener->phase = 0;
+    listener->numPending = 0;
+
+    if (port == NULL || port->gpio != listener->gpio) {
+      assert(listenerSet->numPorts < PIN_LISTENER_MAX_PORTS);
+      port = listenerSet->ports + listenerSet->numPorts++;
+      port->gpio = listener->gpio;
+      port->listeners = listener;
+      port->num = 0;
+      port->stable = 0;
+      port->transient = 0;
+      port->unstable = 0;
+      port->pendingPins = 0;
+    }
+    port->num++;
+  }
+
+  // listeners of a port have to be next to each other in the array
+  for (i = 0; i < listenerSet->numPorts; ++i) {
+    int j;
+    for (j = i + 1; j < listenerSet->numPorts; ++j)
+      assert(listenerSet->ports[i].gpio != listenerSet->ports[j].gpio);
+  }
+
+  // Initialise the pins of the listeners for input
+  GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IN_FLOATING;
+  for (i = 0; i < listenerSet->numPorts; ++i) {
+    GPIO_InitStructure.GPIO_Pin = portPins(listenerSet->ports + i);
+    GPIO_Init(listenerSet->ports[i].gpio, &GPIO_InitStructure);
+  }
 
-  res = xTaskCreate(pollPinsTask, "pin polling",
-                    100, (void*)listenerSet,
-					listenerSet->uxPriority, NULL);
+  listenerSet->droppedEvents = 0;
+
+  if (listenerSet->samplesPerPoll > 1)
+    setupSampleDMA(listenerSet);
+  else
+    listenerSet->samplesPerPoll = 1;
+
+  // the task is created before the interrupts are enabled, which
+  // need its handle
+  res = xTaskCreateStatic(pollPinsTask, "pin polling",
+                          PIN_LISTENER_STACK_SIZE, (void*)listenerSet,
+                          listenerSet->uxPriority, &listenerSet->task,
+                          listenerSet->stack, &listenerSet->taskBuffer);
   assert(res == pdTRUE);
+
+  if (listenerSet->interruptDriven)
+    setupPinInterrupts(listenerSet);
 }
@@ -13,38 +13,149 @@
 
 #include "FreeRTOS.h"
 #include "queue.h"
+#include "task.h"
 #include "stm32f10x_gpio.h"
 
 #include "global.h"
 
-#define RELEASED									0
-#define BOUNCED_RELEASED					10
-#define PRESSED										100
-#define BOUNCED_PRESSED						110
-#define INPUT_UNSTABLE						250
+/**
+ * Debouncing is driven by a transition table indexed by
+ * (state, sample), where the sample is 1 if the pin differs
+ * from its stable value. State 0 is "stable"; a differing
+ * sample starts a transition, which is accepted once "length"
+ * consecutive differing samples have followed it, and which
+ * violates env4 as soon as that can no longer happen within
+ * "window" samples. A length of 0 disables debouncing.
+ *
+ * Transient states encode (samples since the transition
+ * started, consecutive differing samples) as
+ * ((elapsed + 1) << 3) | count. Tables are generated at
+ * compile time with DEBOUNCE_TABLE(length, window); a length
+ * above the window, or a window above DEBOUNCE_MAX_WINDOW,
+ * whose states would alias DEBOUNCE_ACCEPT, fails to compile.
+ * bench/debounce_check.c checks the tables against the
+ * original state machine on every input sequence
+ */
+#define DEBOUNCE_MAX_WINDOW   6
+#define DEBOUNCE_STATES       64
+#define DEBOUNCE_ACCEPT       0x40    // pin changes to the sampled value
+#define DEBOUNCE_UNSTABLE     0x80    // env4 violated
+
+#define DEBOUNCE_STEP(e, c, N, W)                                   \
+  ((c) >= (N) ? DEBOUNCE_ACCEPT :                                   \
+   (W) - (e) < (N) - (c) ? DEBOUNCE_UNSTABLE : (((e) + 1) << 3) | (c))
+#define DEBOUNCE_NEXT(s, d, N, W)                                   \
+  ((s) == 0 ? ((d) ? ((N) == 0 ? DEBOUNCE_ACCEPT : 1 << 3) : 0) :   \
+   DEBOUNCE_STEP((s) >> 3, (d) ? ((s) & 7) + 1 : 0, N, W))
+#define DEBOUNCE_ROW(s, N, W)                                       \
+  { DEBOUNCE_NEXT(s, 0, N, W), DEBOUNCE_NEXT(s, 1, N, W) }
+#define DEBOUNCE_ROWS8(b, N, W)                                     \
+  DEBOUNCE_ROW(b + 0, N, W), DEBOUNCE_ROW(b + 1, N, W),             \
+  DEBOUNCE_ROW(b + 2, N, W), DEBOUNCE_ROW(b + 3, N, W),             \
+  DEBOUNCE_ROW(b + 4, N, W), DEBOUNCE_ROW(b + 5, N, W),             \
+  DEBOUNCE_ROW(b + 6, N, W), DEBOUNCE_ROW(b + 7, N, W)
+// 0, or a negative array size if the parameters are out of range
+#define DEBOUNCE_CHECK(N, W)                                        \
+  ((int)(0 * sizeof(char[(N) <= (W) && (W) <= DEBOUNCE_MAX_WINDOW   \
+                         ? 1 : -1])))
+#define DEBOUNCE_TABLE(N, W)                                        \
+  { { DEBOUNCE_NEXT(0, 0, N, W) + DEBOUNCE_CHECK(N, W),             \
+      DEBOUNCE_NEXT(0, 1, N, W) },                                  \
+    DEBOUNCE_ROW(1, N, W), DEBOUNCE_ROW(2, N, W),                   \
+    DEBOUNCE_ROW(3, N, W), DEBOUNCE_ROW(4, N, W),                   \
+    DEBOUNCE_ROW(5, N, W), DEBOUNCE_ROW(6, N, W),                   \
+    DEBOUNCE_ROW(7, N, W),    DEBOUNCE_ROWS8(8, N, W),              \
+    DEBOUNCE_ROWS8(16, N, W), DEBOUNCE_ROWS8(24, N, W),             \
+    DEBOUNCE_ROWS8(32, N, W), DEBOUNCE_ROWS8(40, N, W),             \
+    DEBOUNCE_ROWS8(48, N, W), DEBOUNCE_ROWS8(56, N, W) }
+
+typedef const u8 DebounceTable[DEBOUNCE_STATES][2];
+
+// Buttons: settled after two samples, with at most one bounce,
+// within the 20 ms of env4 (at 10 ms polling)
+extern DebounceTable debounceButton;
+// Sensors: every change is reported immediately
+extern DebounceTable debounceNone;
 
 typedef struct {
   GPIO_TypeDef * gpio;		  // Pin to listener at, e.g., GPIOC,
   u16 pin;               	  // GPIO_Pin_4
   PinEvent risingEvent;       // Event raised when pin changes from 0 to 1
   PinEvent fallingEvent;      // Event raised when pin changes from 1 to 0
+  DebounceTable *debounce;    // how the pin is debounced
 
-  u8 status;                  // internal state
+  u8 state;                   // internal debounce state
+  u8 phase;                   // samples until the next debounce step
+  portTickType confirmed;     // tick at which the last edge was accepted
+  TimedPinEvent pending[2];   // events that did not fit into the queue
+  u8 numPending;              // yet, oldest first
 } PinListener;
 
+// Inputs can be connected to GPIOA..GPIOE
+#define PIN_LISTENER_MAX_PORTS 5
+
+// Stack of the polling task (words)
+#define PIN_LISTENER_STACK_SIZE 100
+
+/**
+ * Listeners connected to the same port; one bit per pin of the
+ * port, so that quiet pins cost nothing
+ */
+typedef struct {
+  GPIO_TypeDef * gpio;                // Port that is read as a whole
+  PinListener *listeners;             // Listeners connected to this port
+  int num;                            // number of such listeners
+  u16 stable;                         // debounced value of the pins
+  u16 transient;                      // pins that are being debounced
+  u16 unstable;                       // pins that violated env4
+  u16 pendingPins;                    // pins with pending events
+} PinPort;
+
 typedef struct {
-  PinListener *listeners;	          // Array of PinListeners
+  PinListener *listeners;	          // Array of PinListeners, grouped
+                                      // by port
   int num;					          // size of the array
   portTickType pollingPeriod;         // how often the status of pins is polled
   unsigned portBASE_TYPE uxPriority;  // Priority of the polling task
   xQueueHandle pinEventQueue;         // queue where events are sent to
+  bool interruptDriven;               // only poll while an edge (EXTI) is
+                                      // being debounced, sleep otherwise
+  u16 samplesPerPoll;                 // if > 1, the (single) port is sampled
+                                      // this often per polling period by
+                                      // TIM2/DMA, and the samples are
+                                      // processed as a block
+
+  // internal state (set in "setupPinListeners")
+  PinPort ports[PIN_LISTENER_MAX_PORTS];
+  int numPorts;
+  u32 droppedEvents;                  // edges never reported, because they
+                                      // were coalesced with a pending one
+  xTaskHandle task;                   // polling task, notified by the EXTI
+                                      // interrupt handlers
+  xStaticTaskType taskBuffer;         // memory of the polling task
+  portSTACK_TYPE stack[PIN_LISTENER_STACK_SIZE];
 } PinListenerSet;
 
 /**
- * Set up an array of PinListeners. This creates a
- * (single) task that is regularly polling the status of
- * the specified pins
+ * Set up an array of PinListeners. This initialises the pins
+ * for input and creates a (single) task that is regularly
+ * polling the status of the specified pins, reading every
+ * port once per cycle. In interrupt-driven mode, the task
+ * only polls from an edge until all pins have settled again;
+ * at most one set can be interrupt-driven. At most one set,
+ * with all pins on one port, can be sampled by DMA; edges are
+ * then timestamped with the resolution of the samples, while
+ * the task still wakes up once per period, exactly as often as
+ * without DMA. A glitch of a single sample then already starts
+ * a transition (which, with debounceButton, can violate env4),
+ * and samples are lost if the task is more than a buffer late,
+ * so DMA sampling is not used by the elevator
  */
 void setupPinListeners(PinListenerSet *listenerSet);
 
+/**
+ * Check that no pin of the set has violated env4
+ */
+bool pinListenersStable(PinListenerSet *listenerSet);
+
 #endif
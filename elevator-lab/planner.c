@@ -16,33 +16,54 @@
 
 #include "global.h"
 #include "planner.h"
+#include "latency.h"
+#include "watchdog.h"
 #include "assert.h"
-#include "semphr.h"
 
 typedef struct {
 	FloorEvent_t floor[3];	 //floor where car must go
-
-  xSemaphoreHandle lock;          // Mutex semaphore protecting the struct
-
 } floorEventQueue_t;
 
 extern xQueueHandle pinEventQueue;
-//structure holding floor request events
+//structure holding floor request events; only accessed by the planner task
 floorEventQueue_t floorQueue;
 
 FloorEvent_t targetfloor = FLOOR1;
 
+static u8 plannerHeartbeat;
+
+#define PLANNER_STACK_SIZE 100
+
+static xStaticTaskType plannerTaskBuffer;
+static portSTACK_TYPE plannerStack[PLANNER_STACK_SIZE];
+
+//committed target of the request queue, published for other tasks. It is
+//a single aligned word, written only by the planner task, so readers
+//always see a consistent view without taking a lock
+static vu32 floorRequests = FLOOR1;
+
+//publish the current state of the request queue
+static void publishFloorRequests(void);
+
 //pull a floor request event from the queue
 static FloorEvent_t popFloorEvent(void);
-//insert a floor request event into the queue
-static void pushFloorEvent(FloorEvent_t floor);
-//checks if it is possible to stop at floor 2 on the way to floor 1 or 3
-static bool floor2InTheWay(void);
+//insert a floor request event into the queue; returns whether it was added
+static bool pushFloorEvent(FloorEvent_t floor);
+//checks if the car can still stop at a floor on its way to the current target
+static bool floorInTheWay(FloorEvent_t floor, FloorEvent_t target,
+                          s32 position, s32 speed, Direction dir);
+//checks if the car, standing at a floor, stands at the given one
+static bool carAtFloor(FloorEvent_t floor);
 
 static void plannerTask(void *params) {
 
-	PinEvent ev;
-	FloorEvent_t currentfloor = FLOOR1, tempTargetFloor;
+	TimedPinEvent ev;
+	FloorEvent_t tempTargetFloor;
+  FloorEvent_t lastTargetFloor = FLOOR1;
+  portTickType requestTick[3], targetTick = 0;
+  u8 requestSeen = 0;         // queued floors whose request dequeue time is known
+  bool queued;
+  bool awaitingStart = FALSE; // target set, motor not started yet
   bool floorreached = TRUE, doors_closed = FALSE;
   Direction dir = Unknown;
   static u32 timeout = 0;
@@ -59,22 +80,25 @@ static void plannerTask(void *params) {
 
     // check event queue for new event
 		while (xQueueReceive(pinEventQueue, &ev, (portTickType)0 ) == pdTRUE) {
-			switch(ev) {
+      recordLatency(LATENCY_EVENT_TO_DEQUEUE, xTaskGetTickCount() - ev.tick);
+      queued = FALSE;
+
+			switch(ev.event) {
 
 				case TO_FLOOR_1:
           // check current floor
           if(targetfloor != FLOOR1) 
-					  pushFloorEvent(FLOOR1);    // set the floor request only if it isn't the current floor
+					  queued = pushFloorEvent(FLOOR1);    // set the floor request only if it isn't the current floor
 					break;	
 
 				case TO_FLOOR_2:
           if(targetfloor != FLOOR2)
-  					pushFloorEvent(FLOOR2);    // set the floor request only if it isn't the current floor
+  					queued = pushFloorEvent(FLOOR2);    // set the floor request only if it isn't the current floor
 					break;
 
 				case TO_FLOOR_3:
           if(targetfloor != FLOOR3)
-					  pushFloorEvent(FLOOR3);    // set the floor request only if it isn't the current floor
+					  queued = pushFloorEvent(FLOOR3);    // set the floor request only if it isn't the current floor
           break;					 
 				
 				case ARRIVED_AT_FLOOR:
@@ -105,20 +129,31 @@ static void plannerTask(void *params) {
 					break;
 
 			}
+
+      // remember when a floor request was queued
+      if (queued) {
+        requestSeen |= 1 << (ev.event - TO_FLOOR_1);
+        requestTick[ev.event - TO_FLOOR_1] = xTaskGetTickCount();
+      }
 		}
 
     /* only set the target when doors are closed  */
     
 
     dir = getCarDirection();                        
+    if (awaitingStart && dir != Unknown) {
+      recordLatency(LATENCY_TARGET_TO_MOTOR, xTaskGetTickCount() - targetTick);
+      awaitingStart = FALSE;
+    }
     if(floorreached && ( dir == Unknown ) && (timeout < FLOOR_TIMEOUT))
     {
       timeout++;  // increment timer if floor is reached and doors are not oppened
       tmp = 0;
 
-      // test if lift reached the target floor and pop the request from the queue
-      if( targetfloor != currentfloor ){
-         currentfloor = popFloorEvent();
+      // pop the request only once the lift stands at the requested floor;
+      // the car may not even have departed for it yet
+      if( carAtFloor(floorQueue.floor[0]) ){
+         requestSeen &= ~(1 << (popFloorEvent() - FLOOR1));
       }
 
     }
@@ -149,6 +184,18 @@ static void plannerTask(void *params) {
           default:
             break;
         }
+
+        if (targetfloor != lastTargetFloor) {
+          // a new target has been handed to the motor
+          if (requestSeen & (1 << (targetfloor - FLOOR1))) {
+            recordLatency(LATENCY_DEQUEUE_TO_TARGET,
+                          xTaskGetTickCount() - requestTick[targetfloor - FLOOR1]);
+            requestSeen &= ~(1 << (targetfloor - FLOOR1));
+          }
+          targetTick = xTaskGetTickCount();
+          awaitingStart = TRUE;
+          lastTargetFloor = targetfloor;
+        }
       }
 
       // wait for the motor task to change the direction
@@ -175,6 +222,7 @@ static void plannerTask(void *params) {
 
    
 
+		heartbeat(plannerHeartbeat);
 		vTaskDelayUntil(&xLastWakeTime, 10 / portTICK_RATE_MS);
 	}
 
@@ -183,39 +231,38 @@ static void plannerTask(void *params) {
 void setupPlanner(unsigned portBASE_TYPE uxPriority) {
 	u8 i;
 
-	floorQueue.lock = xSemaphoreCreateMutex();
 	//init floorQueue
 	for (i=0;i<3;i++) {
 		floorQueue.floor[i] = UNKNOWN;
 	}
+	publishFloorRequests();
 
-  xTaskCreate(plannerTask, "planner", 100, NULL, uxPriority, NULL);
+  plannerHeartbeat = registerHeartbeat("planner", 100 / portTICK_RATE_MS);
+  xTaskCreateStatic(plannerTask, "planner", PLANNER_STACK_SIZE, NULL, uxPriority, NULL,
+                    plannerStack, &plannerTaskBuffer);
 }
 
 FloorEvent_t readFloorEvent(void) {
-	FloorEvent_t floor;
-		
-	xSemaphoreTake(floorQueue.lock, portMAX_DELAY);
- 	floor = floorQueue.floor[0];
-	xSemaphoreGive(floorQueue.lock);
-
-  if( floor != UNKNOWN ) {
-		//return the first element in the queue
-    return floorQueue.floor[0];
-  }
-  else
-  {
-		//else return current floor
-    return targetfloor;
-  }
+	//the first element in the queue, or the current floor if it is empty
+	return (FloorEvent_t)floorRequests;
+}
+
+void publishFloorRequests(void) {
+	u32 requests;
+
+	if (floorQueue.floor[0] != UNKNOWN)
+		requests = floorQueue.floor[0];
+	else
+		requests = targetfloor;
+
+	//single word store, atomic on the Cortex-M3
+	floorRequests = requests;
 }
 
 //pull a floor request event from the queue
 FloorEvent_t popFloorEvent(void) {
 	FloorEvent_t floor;
 
-	xSemaphoreTake(floorQueue.lock, portMAX_DELAY);
-
 	//get the first element in the queue
 	floor = floorQueue.floor[0];
 	//shift queue to the left by 1 position
@@ -223,38 +270,34 @@ FloorEvent_t popFloorEvent(void) {
 	floorQueue.floor[1] = floorQueue.floor[2];
   floorQueue.floor[2] = UNKNOWN;
 
-	xSemaphoreGive(floorQueue.lock);
+	publishFloorRequests();
 
 	return floor;
 }
 
 //insert a floor request event into the queue
-void pushFloorEvent(FloorEvent_t floor) {
+bool pushFloorEvent(FloorEvent_t floor) {
 	u8 i;
   Direction dir = getCarDirection();
-	
-	xSemaphoreTake(floorQueue.lock, portMAX_DELAY);
+  s32 position = getCarPosition();
+  s32 speed = getCarSpeed();
 
 	//if the event is already in the queue we don't need to push it again
 	for (i=0;i<3;i++) {
 		if (floorQueue.floor[i] == floor) {
-			xSemaphoreGive(floorQueue.lock);
-			return;
+			return FALSE;
 		}
 	}	
 	
-	//if the requested floor is the middle one and lift is mooving
-	if (floor == FLOOR2)  {
-		//if it is possible to stop on the way
-		if (floor2InTheWay()) {
-			//stop to the floor - insert floor at the beginning of 	queue
-			floorQueue.floor[2] = floorQueue.floor[1];
-			floorQueue.floor[1] = floorQueue.floor[0];
-			floorQueue.floor[0] = floor;
-			xSemaphoreGive(floorQueue.lock);
-			return;
-		}
-	} 
+	//if it is possible to stop on the way to the current target
+	if (floorInTheWay(floor, floorQueue.floor[0], position, speed, dir)) {
+		//stop to the floor - insert floor at the beginning of 	queue
+		floorQueue.floor[2] = floorQueue.floor[1];
+		floorQueue.floor[1] = floorQueue.floor[0];
+		floorQueue.floor[0] = floor;
+		publishFloorRequests();
+		return TRUE;
+	}
 	
 	//insert floor at the end of the queue
 	//queue doesn't need to be sorted since we only have 3 floors 
@@ -265,21 +308,76 @@ void pushFloorEvent(FloorEvent_t floor) {
 		}	
 	}
 
-	xSemaphoreGive(floorQueue.lock);
+	publishFloorRequests();
+	return i < 3;
 }
 
-bool floor2InTheWay() {
+//position of a floor in cm
+static s32 floorPosition(FloorEvent_t floor) {
+	switch (floor) {
+		case FLOOR1:
+			return TRACKER_FLOOR1_POS;
+		case FLOOR2:
+			return TRACKER_FLOOR2_POS;
+		case FLOOR3:
+			return TRACKER_FLOOR3_POS;
+		default:
+			assert(0);
+			return -1;
+	}
+}
 
-	s32 position = getCarPosition();
-	Direction dir = getCarDirection();
-	
-	//if going up and can stop safely
-	if (((dir == Up) && (position + SAFE_STOP_DISTANCE <= TRACKER_FLOOR2_POS)) ||
-	//if going down and can stop safely
-		 ((dir == Down) && (position - SAFE_STOP_DISTANCE >= TRACKER_FLOOR2_POS)))	{
+//distance (cm) the car needs to come to a halt from the given speed (cm/s)
+static s32 brakingDistance(s32 speed) {
+	s32 reaction, kinematic;
+
+	if (speed < 0)
+		speed = -speed;
+
+	//distance travelled before the motor sees the new target
+	reaction = (speed * CAR_REACTION_TIME + 999) / 1000;
+	//distance needed at the maximum deceleration
+	kinematic = (speed * speed + 2 * CAR_MAX_DECELERATION - 1) / (2 * CAR_MAX_DECELERATION);
+
+	//the motor slows down proportionally to the remaining distance
+	//(1 cm/s per cm), so it never brakes over less than "speed" cm
+	if (kinematic < speed)
+		kinematic = speed;
+
+	return reaction + kinematic;
+}
+
+bool floorInTheWay(FloorEvent_t floor, FloorEvent_t target,
+                   s32 position, s32 speed, Direction dir) {
+	s32 floorPos, targetPos;
+
+	if (target == UNKNOWN)
+		return FALSE;
+
+	floorPos = floorPosition(floor);
+	targetPos = floorPosition(target);
+
+	//if going up, the floor is before the target and can stop safely;
+	//the floor the car is still standing at is never a stop on the way
+	if (((dir == Up) && (floorPos < targetPos) && (position < floorPos) &&
+	     (position + brakingDistance(speed) <= floorPos)) ||
+	//if going down, the floor is before the target and can stop safely
+		 ((dir == Down) && (floorPos > targetPos) && (position > floorPos) &&
+	     (position - brakingDistance(speed) >= floorPos)))	{
 		return TRUE;
 	}
 	return FALSE;
 }
 
+bool carAtFloor(FloorEvent_t floor) {
+	s32 offset;
 
+	if (floor == UNKNOWN)
+		return FALSE;
+
+	//the floor sensor only tells that the car is at some floor; the
+	//position tells which one
+	offset = getCarPosition() - floorPosition(floor);
+	return offset > -(TRACKER_FLOOR2_POS - TRACKER_FLOOR1_POS) / 2 &&
+	       offset < (TRACKER_FLOOR2_POS - TRACKER_FLOOR1_POS) / 2;
+}
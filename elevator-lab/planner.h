@@ -22,7 +22,8 @@ typedef enum {
 
 void setupPlanner(unsigned portBASE_TYPE uxPriority);
 
-//reads an event from the queue without popping it out
+//reads an event from the queue without popping it out; lock-free, so it
+//can be called from any task
 FloorEvent_t readFloorEvent(void);
 
 #endif
@@ -12,18 +12,27 @@
 #include "task.h"
 #include "global.h"
 #include "position_tracker.h"
+#include "watchdog.h"
 
 #include "assert.h"
 
+// While the car is parked (no direction and no pulse for a while), the
+// pin is polled less often, so that the idle task can stop the tick
+// for longer periods
+#define PARKED_POLLING_FACTOR 10
+#define PARKED_DELAY          (500 / portTICK_RATE_MS)
+
 static void positionTrackerTask(void *params) {
 	portTickType xLastWakeTime;
 
 	static bool pulseHigh = FALSE;
+	portTickType lastPulse, period;
 
 	PositionTracker *tracker = (PositionTracker*)params;
 
 	// Initialise the xLastWakeTime variable with the current time.
 	xLastWakeTime = xTaskGetTickCount();
+	lastPulse = xLastWakeTime;
 
 	for (;;) {
 
@@ -40,6 +49,10 @@ static void positionTrackerTask(void *params) {
         else if( tracker->direction == Down )
           tracker->position--;
         else ;  //do nothing
+
+        tracker->pulses[tracker->pulseCount % PULSE_HISTORY] = xLastWakeTime;
+        tracker->pulseCount++;
+        lastPulse = xLastWakeTime;
   
   			xSemaphoreGive(tracker->lock);
       }
@@ -47,8 +60,15 @@ static void positionTrackerTask(void *params) {
     else
       pulseHigh = FALSE; //reset pulse flag, wait for new pulse
 
-  	//delay for 3 ms since started
-  	vTaskDelayUntil(&xLastWakeTime, tracker->pollingPeriod);
+  	heartbeat(tracker->heartbeat);
+
+  	period = tracker->pollingPeriod;
+  	if (tracker->direction == Unknown &&
+  	    xLastWakeTime - lastPulse > PARKED_DELAY)
+  	  period *= PARKED_POLLING_FACTOR;
+
+  	//delay for 3 ms (30 ms when parked) since started
+  	vTaskDelayUntil(&xLastWakeTime, period);
   }
 
 }
@@ -60,15 +80,18 @@ void setupPositionTracker(PositionTracker *tracker,
   portBASE_TYPE res;
 
   tracker->position = 0;
-  tracker->lock = xSemaphoreCreateMutex();
+  tracker->lock = xSemaphoreCreateMutexStatic(&tracker->lockBuffer);
   assert(tracker->lock != NULL);
   tracker->direction = Unknown;
+  tracker->pulseCount = 0;
   tracker->gpio = gpio;
   tracker->pin = pin;
   tracker->pollingPeriod = pollingPeriod;
+  tracker->heartbeat = registerHeartbeat("position tracker", 50 / portTICK_RATE_MS);
 
-  res = xTaskCreate(positionTrackerTask, "position tracker",
-                    80, (void*)tracker, uxPriority, NULL);
+  res = xTaskCreateStatic(positionTrackerTask, "position tracker",
+                          TRACKER_STACK_SIZE, (void*)tracker, uxPriority, NULL,
+                          tracker->stack, &tracker->taskBuffer);
   assert(res == pdTRUE);
 }
 
@@ -98,6 +121,25 @@ Direction getDirection(PositionTracker *tracker) {
 
 }
 
+u32 getPulseHistory(PositionTracker *tracker, s32 *position,
+                    portTickType *ticks) {
+
+	u32 count;
+	u8 i;
+
+  xSemaphoreTake(tracker->lock, portMAX_DELAY);
+
+	*position = tracker->position;
+	count = tracker->pulseCount;
+	for (i = 0; i < PULSE_HISTORY; ++i)
+		ticks[i] = tracker->pulses[(count + i) % PULSE_HISTORY];
+
+	xSemaphoreGive(tracker->lock);
+
+	return count;
+
+}
+
 s32 getPosition(PositionTracker *tracker) {
 
 	s32 aux;
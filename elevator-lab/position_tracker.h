@@ -22,6 +22,13 @@ typedef enum {
   Unknown = 0, Up = 1, Down = 2
 } Direction;
 
+// Number of pulse timestamps kept (for measuring speed and
+// acceleration)
+#define PULSE_HISTORY 9
+
+// Stack of the tracking task (words)
+#define TRACKER_STACK_SIZE 80
+
 typedef struct {
 
   GPIO_TypeDef * gpio;  		  // Pin to listener at, e.g., GPIOC,
@@ -38,6 +45,16 @@ typedef struct {
                                   // is necessary to know in which direction
 								  // to count
 
+  portTickType pulses[PULSE_HISTORY]; // ticks at which the latest pulses
+                                  // were seen (circular)
+  u32 pulseCount;                 // number of pulses seen so far
+
+  u8 heartbeat;                   // id of the task at the watchdog
+
+  xStaticQueueType lockBuffer;    // memory of the lock and of the
+  xStaticTaskType taskBuffer;     // tracking task
+  portSTACK_TYPE stack[TRACKER_STACK_SIZE];
+
 } PositionTracker; 
 
 /**
@@ -67,4 +84,13 @@ s32 getPosition(PositionTracker *tracker);
  */
 Direction getDirection(PositionTracker *tracker);
 
+/**
+ * Copy the current position and the ticks of the latest
+ * PULSE_HISTORY pulses, oldest first, from the same instant,
+ * and return the number of pulses seen so far. The ticks are
+ * only valid for as many pulses as have been seen
+ */
+u32 getPulseHistory(PositionTracker *tracker, s32 *position,
+                    portTickType *ticks);
+
 #endif
@@ -0,0 +1,640 @@
+/**
+ * Program skeleton for the course "Programming embedded systems"
+ *
+ * Lab 1: the elevator control system
+ */
+
+/**
+ * Offline traffic replay for evaluating planner policies.
+ *
+ * The unmodified planner.c is linked against a simulated car: the
+ * control law of motor.c, the kinematics and sensors of
+ * elevator_simulator.ini, and a passenger model that presses the call
+ * buttons and operates the doors. Simulated time only advances when the
+ * planner task calls vTaskDelayUntil, so the replay runs as fast as the
+ * host allows. Wait time, ride time, stops and motor energy are reported
+ * at the end of the run.
+ *
+ * Build and run on the host (from this directory):
+ *
+ *   gcc -O2 -I.. -I../FreeRTOS/inc -I../STM32F10xFWLib/inc \
+ *       -o replay replay.c ../planner.c ../latency.c -lm
+ *
+ *   ./replay -g 60 -h 1000 -s 1     generated traffic: 60 passengers per
+ *                                   hour during 1000 hours, seed 1
+ *   ./replay -t trace.txt           recorded trace
+ *   ./replay -t pop_before_departure.txt
+ *                                   regression trace, see the file
+ *
+ * A different dispatch policy is evaluated by linking another planner
+ * source instead of ../planner.c.
+ *
+ * If no passenger boards or leaves the car for STALL_TIME while
+ * passengers are waiting or riding, the planner is considered stuck:
+ * the state of the car and of the floor queue is printed, no statistics
+ * are reported, and the tool exits with status 1.
+ *
+ * Trace format: one passenger per line, "<arrival time in s> <from floor>
+ * <to floor>", sorted by arrival time; lines starting with '#' are ignored
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <time.h>
+#include <math.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+#include "global.h"
+#include "planner.h"
+#include "latency.h"
+#include "watchdog.h"
+
+/*-----------------------------------------------------------*/
+/* Simulation parameters */
+
+#define PLANNER_PERIOD     10      // ms, period of the planner task
+#define MOTOR_PERIOD       30      // ms, period of the motor task
+
+// Motor control law, see motor.c
+#define MAX_DUTY           10000
+#define ACCEL_TIME         500
+#define MAX_SPEED          50
+#define MIN_SPEED          3
+#define DUTY_FACTOR        200
+
+// Kinematics, see elevator_simulator.ini: every 2.5 ms the car moves
+// (duty / TIM3_ARR) * 0.125 cm
+#define TIM3_ARR           9999.0
+#define CM_PER_PERIOD      (0.125 * PLANNER_PERIOD / 2.5)
+
+#define FLOOR_COUNT        3
+#define FLOOR_SENSOR_RANGE 0.5     // cm, see elevator_simulator.ini
+
+#define DOOR_OPEN_TIME     1000    // ms the doors stay open at a stop
+#define REPRESS_INTERVAL   5000    // ms after which waiting passengers
+                                   // press their button again
+#define CAR_CAPACITY       8
+#define MAX_WAITING        256     // passengers waiting per floor
+#define IDLE_SKIP_MARGIN   5000    // ms; an idle car is fast-forwarded
+                                   // to this long before the next arrival
+#define DRAIN_TIME         (3600L * 1000)  // ms to serve remaining
+                                           // passengers after the trace ends
+#define STALL_TIME         (10L * 60 * 1000)  // ms without any passenger
+                                              // served before the run is
+                                              // aborted
+
+#define HISTOGRAM_SIZE     600     // 1 s buckets for percentiles
+
+#define EVENT_QUEUE_SIZE   32      // same as pinEventQueue in main.c
+
+/*-----------------------------------------------------------*/
+/* Passenger source */
+
+typedef unsigned long long SimTime;   // ms since start of the replay
+
+typedef struct {
+  SimTime arrival;
+  u8 from, to;                     // floors 1..FLOOR_COUNT
+  SimTime boarded;
+} Passenger;
+
+static FILE *traceFile = NULL;
+static u32 generatedRate = 0;      // passengers per hour
+static u32 simulatedHours = 1;
+static u32 randomState = 1;
+
+static int havePending = 0;
+static Passenger pending;          // next passenger to arrive
+
+static u32 nextRandom(void) {
+  randomState = randomState * 1103515245 + 12345;
+  return (randomState >> 8) & 0xFFFFFF;
+}
+
+// uniformly distributed in [0, 1)
+static double uniform(void) {
+  return nextRandom() / (double)0x1000000;
+}
+
+// exponentially distributed with the given mean
+static double exponential(double mean) {
+  return -mean * log(1.0 - uniform());
+}
+
+static int readPassenger(Passenger *p) {
+  static double lastArrival = 0.0;
+  char line[128];
+  double arrival;
+  int from, to;
+
+  if (traceFile != NULL) {
+    while (fgets(line, sizeof(line), traceFile) != NULL) {
+      if (line[0] == '#' ||
+          sscanf(line, "%lf %d %d", &arrival, &from, &to) != 3)
+        continue;
+      if (from < 1 || from > FLOOR_COUNT || to < 1 || to > FLOOR_COUNT ||
+          from == to) {
+        fprintf(stderr, "ignoring invalid trace line: %s", line);
+        continue;
+      }
+      p->arrival = (SimTime)(arrival * 1000.0);
+      p->from = (u8)from;
+      p->to = (u8)to;
+      return 1;
+    }
+    return 0;
+  }
+
+  lastArrival += exponential(3600.0 * 1000.0 / generatedRate);
+  if (lastArrival >= simulatedHours * 3600.0 * 1000.0)
+    return 0;
+  p->arrival = (SimTime)lastArrival;
+  p->from = (u8)(1 + nextRandom() % FLOOR_COUNT);
+  p->to = (u8)(1 + (p->from + nextRandom() % (FLOOR_COUNT - 1)) % FLOOR_COUNT);
+  return 1;
+}
+
+/*-----------------------------------------------------------*/
+/* Simulated car and environment */
+
+static SimTime now = 0;
+static u8 motorPhase = 0;          // planner periods since the last
+                                   // motor update
+static jmp_buf simulationDone;
+
+static double carPos = 0.0;        // cm, exact position of the car
+static s32 trackerPos = 0;         // cm, position as counted from pulses
+static Direction carDirection = Unknown;
+static s32 targetPos = 0;
+static u8 motorStopped = 0;
+static s32 duty = 0;
+static bool atFloor = TRUE;
+
+static bool doorsOpen = FALSE;
+static SimTime doorsClosingAt = 0;
+
+static Passenger waiting[FLOOR_COUNT][MAX_WAITING];
+static u16 waitingHead[FLOOR_COUNT], waitingCount[FLOOR_COUNT];
+static Passenger inCar[CAR_CAPACITY];
+static u8 inCarCount = 0;
+static SimTime lastPress[FLOOR_COUNT];
+
+static int traceEnded = 0;
+
+static SimTime lastServed = 0;     // a passenger boarded or left the car
+
+/*-----------------------------------------------------------*/
+/* Statistics */
+
+typedef struct {
+  u32 count;
+  double sum;
+  u32 max;
+  u32 histogram[HISTOGRAM_SIZE];
+} Statistic;
+
+static Statistic waitTime, rideTime;
+static u32 stops = 0, droppedEvents = 0, rejectedPassengers = 0;
+static double energy = 0.0;        // s at full motor power
+static double distance = 0.0;      // cm travelled
+
+static void record(Statistic *stat, SimTime ms) {
+  SimTime bucket = ms / 1000;
+
+  stat->count++;
+  stat->sum += ms;
+  if (ms > stat->max)
+    stat->max = (u32)ms;
+  if (bucket >= HISTOGRAM_SIZE)
+    bucket = HISTOGRAM_SIZE - 1;
+  stat->histogram[bucket]++;
+}
+
+static double percentile(Statistic *stat, double p) {
+  u32 threshold = (u32)(stat->count * p), seen = 0;
+  int i;
+
+  for (i = 0; i < HISTOGRAM_SIZE; ++i) {
+    seen += stat->histogram[i];
+    if (seen > threshold)
+      return i + 1;
+  }
+  return HISTOGRAM_SIZE;
+}
+
+static void printStatistic(const char *name, Statistic *stat) {
+  if (stat->count == 0) {
+    printf("%-10s no samples\n", name);
+    return;
+  }
+  printf("%-10s mean %7.2f s   p95 <= %4.0f s   max %7.2f s\n", name,
+         stat->sum / stat->count / 1000.0, percentile(stat, 0.95),
+         stat->max / 1000.0);
+}
+
+/*-----------------------------------------------------------*/
+/* Event queue between the simulated inputs and the planner */
+
+xQueueHandle pinEventQueue = (xQueueHandle)&pinEventQueue;
+
+static TimedPinEvent events[EVENT_QUEUE_SIZE];
+static u8 eventHead = 0, eventCount = 0;
+
+static void sendEvent(PinEvent ev) {
+  if (eventCount == EVENT_QUEUE_SIZE) {
+    droppedEvents++;
+    return;
+  }
+  events[(eventHead + eventCount) % EVENT_QUEUE_SIZE].event = ev;
+  events[(eventHead + eventCount) % EVENT_QUEUE_SIZE].tick = xTaskGetTickCount();
+  eventCount++;
+}
+
+static void pressButton(u8 floor) {
+  sendEvent((PinEvent)(TO_FLOOR_1 + floor - 1));
+  lastPress[floor - 1] = now;
+}
+
+/*-----------------------------------------------------------*/
+
+// control law of motorTask in motor.c
+static void updateMotor(void) {
+  s32 maxDutyChange = MAX_DUTY * MOTOR_PERIOD / ACCEL_TIME;
+  s32 limit, distanceLeft;
+
+  if (motorStopped) {
+    if (duty >= maxDutyChange)
+      duty -= maxDutyChange;
+    else if (duty <= -maxDutyChange)
+      duty += maxDutyChange;
+    else
+      duty = 0;
+  } else if (targetPos != trackerPos) {
+    distanceLeft = targetPos > trackerPos ? targetPos - trackerPos
+                                          : trackerPos - targetPos;
+    if (distanceLeft > MAX_SPEED)
+      distanceLeft = MAX_SPEED;
+    if (distanceLeft < MIN_SPEED)
+      distanceLeft = MIN_SPEED;
+    limit = distanceLeft * DUTY_FACTOR;
+
+    if (targetPos > trackerPos) {
+      carDirection = Up;
+      duty = duty + maxDutyChange < limit ? duty + maxDutyChange : limit;
+    } else {
+      carDirection = Down;
+      duty = -duty + maxDutyChange < limit ? duty - maxDutyChange : -limit;
+    }
+  } else {
+    carDirection = Unknown;
+    duty = 0;
+  }
+}
+
+static bool floorSensor(void) {
+  int i;
+
+  for (i = 0; i < FLOOR_COUNT; ++i) {
+    double floorPos = TRACKER_FLOOR1_POS +
+                      i * (TRACKER_FLOOR2_POS - TRACKER_FLOOR1_POS);
+    if (carPos >= floorPos - FLOOR_SENSOR_RANGE &&
+        carPos <= floorPos + FLOOR_SENSOR_RANGE)
+      return TRUE;
+  }
+  return FALSE;
+}
+
+static s32 currentFloor(void) {
+  return (trackerPos - TRACKER_FLOOR1_POS +
+          (TRACKER_FLOOR2_POS - TRACKER_FLOOR1_POS) / 2) /
+         (TRACKER_FLOOR2_POS - TRACKER_FLOOR1_POS) + 1;
+}
+
+static void openDoors(void) {
+  u8 floor = (u8)currentFloor();
+  u8 i, j;
+
+  doorsOpen = TRUE;
+  doorsClosingAt = now + DOOR_OPEN_TIME;
+  stops++;
+  sendEvent(DOORS_OPENING);
+
+  // passengers leave the car
+  for (i = 0, j = 0; i < inCarCount; ++i) {
+    if (inCar[i].to == floor) {
+      record(&rideTime, now - inCar[i].boarded);
+      lastServed = now;
+    } else
+      inCar[j++] = inCar[i];
+  }
+  inCarCount = j;
+}
+
+// passengers waiting at the current floor enter the open car
+static void boardPassengers(void) {
+  u8 floor = (u8)currentFloor();
+  Passenger *p;
+
+  while (waitingCount[floor - 1] > 0 && inCarCount < CAR_CAPACITY) {
+    p = &waiting[floor - 1][waitingHead[floor - 1]];
+    waitingHead[floor - 1] = (waitingHead[floor - 1] + 1) % MAX_WAITING;
+    waitingCount[floor - 1]--;
+
+    p->boarded = now;
+    record(&waitTime, now - p->arrival);
+    lastServed = now;
+    inCar[inCarCount++] = *p;
+    pressButton(p->to);
+  }
+}
+
+static void arrivePassengers(void) {
+  u8 floor;
+
+  while (!traceEnded && (havePending || (havePending = readPassenger(&pending)))
+         && pending.arrival <= now) {
+    floor = pending.from;
+    if (waitingCount[floor - 1] == MAX_WAITING) {
+      rejectedPassengers++;
+    } else {
+      waiting[floor - 1][(waitingHead[floor - 1] + waitingCount[floor - 1])
+                         % MAX_WAITING] = pending;
+      waitingCount[floor - 1]++;
+      pressButton(floor);
+    }
+    havePending = 0;
+  }
+  if (!havePending && !traceEnded && !(havePending = readPassenger(&pending)))
+    traceEnded = 1;
+}
+
+static bool passengersWaiting(void) {
+  int i;
+
+  if (inCarCount > 0)
+    return TRUE;
+  for (i = 0; i < FLOOR_COUNT; ++i)
+    if (waitingCount[i] > 0)
+      return TRUE;
+  return FALSE;
+}
+
+static bool carIdle(void) {
+  return !passengersWaiting() && !doorsOpen && duty == 0 && eventCount == 0;
+}
+
+// state of planner.c, printed when the planner is stuck; weak, so that
+// other planner sources can still be linked
+typedef struct {
+  FloorEvent_t floor[3];
+} floorEventQueue_t;
+
+extern floorEventQueue_t floorQueue __attribute__((weak));
+extern FloorEvent_t targetfloor __attribute__((weak));
+
+static void reportStall(void) {
+  printf("STALL: no passenger served for %llu s at t=%.3f h\n",
+         (now - lastServed) / 1000, now / 3600000.0);
+  printf("car        %ld cm, direction %d, duty %ld, target %ld cm, "
+         "doors %s%s\n", trackerPos, carDirection, duty, targetPos,
+         doorsOpen ? "open" : "closed", motorStopped ? ", motor stopped" : "");
+  printf("passengers %u/%u/%u waiting at floor 1/2/3, %u in the car\n",
+         waitingCount[0], waitingCount[1], waitingCount[2], inCarCount);
+  printf("planner    committed floor %d", readFloorEvent());
+  if (&targetfloor != NULL)
+    printf(", targetfloor %d", targetfloor);
+  if (&floorQueue != NULL)
+    printf(", floorQueue [%d,%d,%d]", floorQueue.floor[0],
+           floorQueue.floor[1], floorQueue.floor[2]);
+  printf("\n");
+  exit(1);
+}
+
+// advance the simulated world by one planner period
+static void simulationStep(void) {
+  bool sensor;
+  u8 here;
+  int i;
+
+  now += PLANNER_PERIOD;
+
+  if (++motorPhase == MOTOR_PERIOD / PLANNER_PERIOD) {
+    motorPhase = 0;
+    updateMotor();
+  }
+
+  carPos += (duty / TIM3_ARR) * CM_PER_PERIOD;
+  distance += (duty < 0 ? -duty : duty) / TIM3_ARR * CM_PER_PERIOD;
+  energy += (duty < 0 ? -duty : duty) / (double)MAX_DUTY *
+            PLANNER_PERIOD / 1000.0;
+
+  // the position tracker counts one pulse per cm
+  // (rising pulse edges at x.75 upwards and at x.25 downwards)
+  if (carDirection == Up)
+    trackerPos = (s32)floor(carPos + 0.25);
+  else if (carDirection == Down)
+    trackerPos = (s32)ceil(carPos - 0.25);
+
+  sensor = floorSensor();
+  if (sensor != atFloor)
+    sendEvent(sensor ? ARRIVED_AT_FLOOR : LEFT_FLOOR);
+  atFloor = sensor;
+
+  arrivePassengers();
+
+  if (doorsOpen) {
+    boardPassengers();
+    if (now >= doorsClosingAt) {
+      doorsOpen = FALSE;
+      sendEvent(DOORS_CLOSED);
+    }
+  } else if (atFloor && duty == 0 && carDirection == Unknown) {
+    // open the doors when somebody wants to leave or enter here
+    here = (u8)currentFloor();
+    for (i = 0; i < inCarCount; ++i)
+      if (inCar[i].to == here)
+        break;
+    if (i < inCarCount || waitingCount[here - 1] > 0)
+      openDoors();
+  }
+
+  // impatient passengers press their buttons again
+  for (i = 0; i < FLOOR_COUNT; ++i) {
+    if (now - lastPress[i] < REPRESS_INTERVAL)
+      continue;
+    if (waitingCount[i] > 0)
+      pressButton((u8)(i + 1));
+  }
+  for (i = 0; i < inCarCount; ++i)
+    if (now - lastPress[inCar[i].to - 1] >= REPRESS_INTERVAL)
+      pressButton(inCar[i].to);
+
+  if (!passengersWaiting())
+    lastServed = now;
+  else if (now - lastServed > STALL_TIME)
+    reportStall();
+
+  if (carIdle()) {
+    if (traceEnded)
+      longjmp(simulationDone, 1);
+    if (havePending && pending.arrival > now + IDLE_SKIP_MARGIN)
+      now = (pending.arrival - IDLE_SKIP_MARGIN) / PLANNER_PERIOD
+            * PLANNER_PERIOD;
+  } else if (traceEnded && now - pending.arrival > DRAIN_TIME) {
+    longjmp(simulationDone, 1);
+  }
+}
+
+/*-----------------------------------------------------------*/
+/* Kernel services used by the planner */
+
+static pdTASK_CODE plannerTaskCode = NULL;
+static void *plannerTaskParams = NULL;
+
+signed portBASE_TYPE xTaskGenericCreate(pdTASK_CODE pvTaskCode,
+                                        const signed char * const pcName,
+                                        unsigned short usStackDepth,
+                                        void *pvParameters,
+                                        unsigned portBASE_TYPE uxPriority,
+                                        xTaskHandle *pxCreatedTask,
+                                        portSTACK_TYPE *puxStackBuffer,
+                                        xStaticTaskType *pxTaskBuffer,
+                                        const xMemoryRegion * const xRegions) {
+  plannerTaskCode = pvTaskCode;
+  plannerTaskParams = pvParameters;
+  return pdTRUE;
+}
+
+portTickType xTaskGetTickCount(void) {
+  return (portTickType)(now / portTICK_RATE_MS);
+}
+
+void vTaskDelayUntil(portTickType * const pxPreviousWakeTime,
+                     portTickType xTimeIncrement) {
+  simulationStep();
+  *pxPreviousWakeTime = xTaskGetTickCount();
+}
+
+signed portBASE_TYPE xQueueGenericReceive(xQueueHandle xQueue,
+                                          void * const pvBuffer,
+                                          portTickType xTicksToWait,
+                                          portBASE_TYPE xJustPeek) {
+  if (eventCount == 0)
+    return pdFALSE;
+  *(TimedPinEvent*)pvBuffer = events[eventHead];
+  eventHead = (eventHead + 1) % EVENT_QUEUE_SIZE;
+  eventCount--;
+  return pdTRUE;
+}
+
+// the planner checks in at the watchdog; there is none here
+u8 registerHeartbeat(const char *name, portTickType deadline) {
+  return 0;
+}
+
+void heartbeat(u8 id) {
+}
+
+void assert_failed(u8* file, u32 line) {
+  printf("ASSERTION FAILURE: %s:%lu at t=%llu ms\n", file, line, now);
+}
+
+/*-----------------------------------------------------------*/
+/* Functions defined in global.h */
+
+s32 getCarPosition(void) {
+  return trackerPos;
+}
+
+s32 getCarTargetPosition(void) {
+  return targetPos;
+}
+
+void setCarTargetPosition(s32 target) {
+  targetPos = target;
+}
+
+void setCarMotorStopped(u8 stopped) {
+  motorStopped = stopped;
+}
+
+Direction getCarDirection(void) {
+  return carDirection;
+}
+
+s32 getCarSpeed(void) {
+  return duty / DUTY_FACTOR;
+}
+
+/*-----------------------------------------------------------*/
+
+static void usage(const char *name) {
+  fprintf(stderr,
+          "usage: %s -t <trace file>\n"
+          "       %s -g <passengers per hour> [-h <hours>] [-s <seed>]\n",
+          name, name);
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  clock_t started;
+  double seconds;
+  int i;
+
+  for (i = 1; i < argc; ++i) {
+    if (i + 1 >= argc)
+      usage(argv[0]);
+    if (!strcmp(argv[i], "-t")) {
+      traceFile = fopen(argv[++i], "r");
+      if (traceFile == NULL) {
+        perror(argv[i]);
+        return 1;
+      }
+    } else if (!strcmp(argv[i], "-g")) {
+      generatedRate = (u32)atol(argv[++i]);
+    } else if (!strcmp(argv[i], "-h")) {
+      simulatedHours = (u32)atol(argv[++i]);
+    } else if (!strcmp(argv[i], "-s")) {
+      randomState = (u32)atol(argv[++i]);
+    } else {
+      usage(argv[0]);
+    }
+  }
+  if ((traceFile == NULL) == (generatedRate == 0))
+    usage(argv[0]);
+
+  setupPlanner(1);
+  if (plannerTaskCode == NULL) {
+    fprintf(stderr, "planner did not create a task\n");
+    return 1;
+  }
+
+  // the doors are closed when the system starts, see testcase*.ini
+  sendEvent(DOORS_CLOSED);
+
+  started = clock();
+  if (!setjmp(simulationDone))
+    plannerTaskCode(plannerTaskParams);
+  seconds = (double)(clock() - started) / CLOCKS_PER_SEC;
+
+  printf("simulated  %.1f h in %.2f s\n", now / 3600000.0, seconds);
+  printf("passengers %lu served, %lu unserved, %lu rejected\n",
+         rideTime.count,
+         waitTime.count - rideTime.count + waitingCount[0] + waitingCount[1]
+         + waitingCount[2],
+         rejectedPassengers);
+  printStatistic("wait", &waitTime);
+  printStatistic("ride", &rideTime);
+  printf("stops      %lu\n", stops);
+  printf("energy     %.1f s at full power, %.1f m travelled\n",
+         energy, distance / 100.0);
+  printf("events     %lu dropped\n", droppedEvents);
+  printLatencyHistograms();
+
+  return 0;
+}
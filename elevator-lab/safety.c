@@ -17,157 +17,516 @@
 #include <stdio.h>
 
 #include "global.h"
+#include "safety.h"
+#include "watchdog.h"
+#include "journal.h"
+#include "logger.h"
 #include "assert.h"
 
-#define CAR_SPEED_SAMPLING_INTERVAL (60 / portTICK_RATE_MS	/ POLL_TIME)
-#define CAR_STOP_PERIOD (1000 / portTICK_RATE_MS / POLL_TIME)
-
 #define POLL_TIME (10 / portTICK_RATE_MS)
 
+// durations in safety cycles
+#define CYCLES(ms) ((ms) / portTICK_RATE_MS / POLL_TIME)
 
-#define MOTOR_UPWARD   (TIM3->CCR1)
-#define MOTOR_DOWNWARD (TIM3->CCR2)
-#define MOTOR_STOPPED  (!MOTOR_UPWARD && !MOTOR_DOWNWARD)
-
-#define STOP_PRESSED  GPIO_ReadInputDataBit(GPIOC, GPIO_Pin_3)
-#define AT_FLOOR      GPIO_ReadInputDataBit(GPIOC, GPIO_Pin_7)
-#define DOORS_CLOSED  GPIO_ReadInputDataBit(GPIOC, GPIO_Pin_8)
+/**
+ * Inputs and outputs of the system, taken once at the start
+ * of each safety cycle; all requirements are evaluated on the
+ * same snapshot
+ */
+typedef struct {
+  u16 inputs;           // GPIOC input data register
+  u16 up, down;         // PWM duty of the motor signals (TIM3 CCR1/CCR2)
+  s32 position;         // position of the car
+  s32 carTarget;        // target position of the motor
+  s32 plannerTarget;    // target position of the planner
+  bool inputsStable;    // no input violated env4
+  portTickType now;     // tick at which the snapshot was taken
+  u32 pulseCount;       // position pulses seen so far
+  portTickType pulses[PULSE_HISTORY]; // ticks of the latest pulses
+} Snapshot;
+
+#define MOTOR_UPWARD(s)   ((s)->up)
+#define MOTOR_DOWNWARD(s) ((s)->down)
+#define MOTOR_STOPPED(s)  (!MOTOR_UPWARD(s) && !MOTOR_DOWNWARD(s))
+
+#define STOP_PRESSED(s)   (((s)->inputs & GPIO_Pin_3) != 0)
+#define AT_FLOOR(s)       (((s)->inputs & GPIO_Pin_7) != 0)
+#define DOORS_CLOSED(s)   (((s)->inputs & GPIO_Pin_8) != 0)
+
+// Speed and acceleration are computed in fixed point (1/256 cm/s,
+// 1/256 cm/s^2). A limit is exceeded once the estimate is above
+// the limit plus the hysteresis, which absorbs the resolution of
+// the pulse timestamps (the polling period of the position
+// tracker), and until it is back below the limit
+#define Q8(x)             ((u32)(x) << 8)
+#define SPEED_HYSTERESIS  10    // cm/s
+#define ACCEL_HYSTERESIS  50    // cm/s^2
+
+// pulses per window of the acceleration estimate
+#define ACCEL_WINDOW      ((PULSE_HISTORY - 1) / 2)
+
+// Cycle counter of the Cortex-M3 data watchpoint and trace unit
+#define DEMCR         (*(vu32*)0xE000EDFC)
+#define DEMCR_TRCENA  0x01000000
+#define DWT_CTRL      (*(vu32*)0xE0001000)
+#define DWT_CYCCNT    (*(vu32*)0xE0001004)
+#define DWT_CYCCNTENA 0x00000001
+
+#define CYCLES_PER_US (configCPU_CLOCK_HZ / 1000000)
+
+// Execution time one safety cycle may take before the budget
+// alarm is raised
+#ifndef SAFETY_BUDGET_US
+#define SAFETY_BUDGET_US 1000
+#endif
+
+// Stacks of the safety task and of the report task (words)
+#define SAFETY_STACK_SIZE        100
+#define SAFETY_REPORT_STACK_SIZE 120
+
+typedef bool (*Predicate)(const Snapshot *s);
 
-#define ABS(x)        ((x) >= 0 ? (x) : (-x))
+/**
+ * Kinds of monitors; bounds are given in safety cycles
+ */
+typedef enum {
+  INVARIANT,    // "holds" is true in every cycle
+  WITHIN,       // while "trigger" is true, "holds" becomes true within
+                // "bound" cycles (and is true from then on)
+  DWELL,        // once "trigger" becomes true, "holds" stays true for
+                // more than "bound" cycles
+  ON_ENTRY      // when "trigger" becomes true, "holds" is true, or "since"
+                // has been true since "trigger" was last false
+} MonitorKind;
+
+#define NO_MARGIN 0xFFFF
+
+typedef struct {
+  const char *name;
+  MonitorKind kind;
+  Predicate trigger, holds, since;
+  u16 bound;
+
+  // evaluation state
+  bool triggered;       // value of "trigger" in the previous cycle
+  bool latched;         // obligation running (DWELL), response seen
+                        // (WITHIN), "since" seen (ON_ENTRY)
+  u16 elapsed;          // cycles since the obligation started
+  u16 margin;           // smallest slack to the bound observed so far
+  u32 maxCost;          // most expensive evaluation (CPU cycles)
+} Requirement;
 
 static portTickType xLastWakeTime;
+static portTickType reportPeriod;
+static u8 safetyHeartbeat;
+
+static xStaticTaskType safetyTaskBuffer, reportTaskBuffer;
+static portSTACK_TYPE safetyStack[SAFETY_STACK_SIZE];
+static portSTACK_TYPE reportStack[SAFETY_REPORT_STACK_SIZE];
+
+static SafetyTiming timing = { 0xFFFFFFFF, 0, 0, 0, 0, 0 };
+
+/**
+ * The values shared with other tasks are read first. The
+ * position tracker (and the watchdog supervisor) run at a
+ * higher priority than the safety task and can preempt it
+ * within the cycle, so the position and the pulse history
+ * are copied together under the tracker's lock. The registers
+ * are then read back to back, so that the pins and the motor
+ * signals are from the same instant
+ */
+static void takeSnapshot(Snapshot *s) {
+  s->pulseCount = getCarPulseHistory(&s->position, s->pulses);
+  s->carTarget = getCarTargetPosition();
+  s->plannerTarget = getPlannerTargetPosition();
+  s->inputsStable = checkInputsStabilized();
+  s->now = xTaskGetTickCount();
+
+  taskENTER_CRITICAL();
+  s->inputs = GPIO_ReadInputData(GPIOC);
+  s->up = TIM3->CCR1;
+  s->down = TIM3->CCR2;
+  taskEXIT_CRITICAL();
+}
+
+/*-----------------------------------------------------------*/
+/* Predicates */
+
+static bool motorStopped(const Snapshot *s) {
+  return MOTOR_STOPPED(s);
+}
+
+static bool stopPressed(const Snapshot *s) {
+  return STOP_PRESSED(s);
+}
 
+static bool atFloor(const Snapshot *s) {
+  return AT_FLOOR(s);
+}
+
+static bool stoppedAtFloor(const Snapshot *s) {
+  return MOTOR_STOPPED(s) && AT_FLOOR(s);
+}
+
+// Environment assumption 1: the doors can only be opened if
+//                           the elevator is at a floor and
+//                           the motor is not active
+static bool env1(const Snapshot *s) {
+  return (AT_FLOOR(s) && MOTOR_STOPPED(s)) || DOORS_CLOSED(s);
+}
 
-static void check(u8 assertion, char *name) {
-  if (!assertion) {		
+// average speed over "cm" pulses that took "ticks"
+static u32 speedQ8(u32 cm, portTickType ticks) {
+  u32 ms = ticks * portTICK_RATE_MS;
 
-    printf("SAFETY REQUIREMENT %s VIOLATED: STOPPING ELEVATOR\n", name);
-    for (;;) {
-	  setCarMotorStopped(1);
-  	  vTaskDelayUntil(&xLastWakeTime, POLL_TIME);
+  return Q8(cm * 1000) / (ms ? ms : 1);
+}
+
+// acceleration between two speeds measured "ticks" apart
+static u32 accelQ8(u32 v0, u32 v1, portTickType ticks) {
+  u32 ms = ticks * portTICK_RATE_MS;
+
+  return (v1 > v0 ? v1 - v0 : v0 - v1) * 1000 / (ms ? ms : 1);
+}
+
+// comparator with hysteresis
+static bool exceeds(bool *above, u32 value, u32 limit, u32 hysteresis) {
+  if (value > limit + hysteresis)
+    *above = TRUE;
+  else if (value <= limit)
+    *above = FALSE;
+  return *above;
+}
+
+// Environment assumption 2: The elevator moves at a maximum speed of 50cm/s
+// (measured over the interval between the two latest pulses, i.e., at
+// every pulse)
+static bool env2(const Snapshot *s) {
+  static bool above = FALSE;
+  const portTickType *t = s->pulses + PULSE_HISTORY - 2;
+
+  if (s->pulseCount >= 2)
+    exceeds(&above, speedQ8(1, t[1] - t[0]),
+            Q8(CAR_MAX_SPEED), Q8(SPEED_HYSTERESIS));
+  return !above;
+}
+
+// Environment assumption 3
+// If the ground floor is put at 0cm in an absolute coordinate system, 
+// the second floor is at 400cm and 
+// the third floor at 800cm (the at-floor sensor reports a floor with a threshold of +-0.5cm)
+static bool env3(const Snapshot *s) {
+  s32 currentPosition = s->position;
+
+  return !AT_FLOOR(s) ||
+         ( currentPosition <= ( TRACKER_FLOOR1_POS + 1 )) ||
+        (( currentPosition >= ( TRACKER_FLOOR2_POS - 1 )) && ( currentPosition <= ( TRACKER_FLOOR2_POS + 1 ))) ||
+         ( currentPosition >= ( TRACKER_FLOOR3_POS - 1 ));
+}
+
+// Environment assumption 4: The values of the inputs stabilize on 0 or 1 within 20 ms 
+static bool env4(const Snapshot *s) {
+  return s->inputsStable;
+}
+
+// System requirement 2: the motor signals for upwards and downwards
+//                       movement are not active at the same time
+static bool req2(const Snapshot *s) {
+  return !MOTOR_UPWARD(s) || !MOTOR_DOWNWARD(s);
+}
+
+// Safety requirement 3: The elevator may not pass the end positions, that is, go through the roof or the floor 
+static bool req3(const Snapshot *s) {
+  s32 currentPosition = s->position;
+
+  return (currentPosition >= TRACKER_FLOOR1_POS) && (currentPosition <= TRACKER_FLOOR3_POS);
+}
+
+// Safety requirement 7: The maximum accelleration/decelleration of the elevator is 100 cm / s2
+// At every pulse, the average speeds over the two latest windows of pulses
+// are compared. While no pulse arrives, the car has moved less than 1 cm since
+// the last one, which bounds its speed from above, so that a sudden stop is
+// noticed as well
+static bool req7(const Snapshot *s) {
+  static u32 lastCount = 0;
+  static bool above = FALSE;
+  const portTickType *t = s->pulses;
+  const portTickType *last = t + PULSE_HISTORY - 1;
+  u32 v0, v1, accel;
+  portTickType since;
+
+  if (s->pulseCount < PULSE_HISTORY)
+    return TRUE;
+
+  // speed over the latest window, centred half a window before the last pulse
+  v1 = speedQ8(ACCEL_WINDOW, *last - last[-ACCEL_WINDOW]);
+
+  if (s->pulseCount != lastCount) {
+    lastCount = s->pulseCount;
+    v0 = speedQ8(ACCEL_WINDOW, last[-ACCEL_WINDOW] - t[0]);
+    accel = accelQ8(v0, v1, (*last - t[0]) / 2);
+  } else {
+    since = s->now - *last;
+    v0 = speedQ8(1, since);
+    if (v0 >= v1)
+      return !above;
+    accel = accelQ8(v1, v0, (*last - last[-ACCEL_WINDOW] + since) / 2);
+  }
+
+  exceeds(&above, accel, Q8(CAR_MAX_DECELERATION), Q8(ACCEL_HYSTERESIS));
+  return !above;
+}
+
+// Safety requirement 8: The elevator moves only when it is called/ordered to go to a floor
+static bool req8(const Snapshot *s) {
+  return MOTOR_STOPPED(s) || (s->plannerTarget == s->carTarget);
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * The requirements; adding one means adding a row
+ */
+static Requirement requirements[] = {
+  { "env1", INVARIANT, NULL, env1, NULL, 0 },
+  { "env2", INVARIANT, NULL, env2, NULL, 0 },
+  { "env3", INVARIANT, NULL, env3, NULL, 0 },
+  { "env4", INVARIANT, NULL, env4, NULL, 0 },
+
+  // System requirement 1: if the stop button is pressed, the motor is
+  //                       stopped within 1s
+  { "req1", WITHIN,    stopPressed, motorStopped, NULL, CYCLES(1000) },
+  { "req2", INVARIANT, NULL, req2, NULL, 0 },
+  { "req3", INVARIANT, NULL, req3, NULL, 0 },
+  // Safety requirement 4: A moving elevator halts only if the stop button
+  //                       is pressed or the elevator has arrived at a floor
+  { "req4", ON_ENTRY,  motorStopped, atFloor, stopPressed, 0 },
+  // Safety requirement 5: Once the elevator has stopped at a floor, it will
+  //                       wait for at least 1s before it continues to another floor
+  { "req5", DWELL,     stoppedAtFloor, motorStopped, NULL, FLOOR_TIMEOUT },
+  // Safety requirement 6: The elevator will not move while the doors are open
+  //                       (covered by env1)
+  { "req7", INVARIANT, NULL, req7, NULL, 0 },
+  { "req8", INVARIANT, NULL, req8, NULL, 0 }
+};
+
+#define REQUIREMENTS (sizeof(requirements) / sizeof(requirements[0]))
+
+static void recordMargin(Requirement *r, u16 margin) {
+  if (margin < r->margin)
+    r->margin = margin;
+}
+
+static bool evaluate(Requirement *r, const Snapshot *s) {
+  bool trigger, ok = TRUE;
+
+  switch (r->kind) {
+
+  case INVARIANT:
+    return r->holds(s);
+
+  case WITHIN:
+    if (!r->trigger(s)) {
+      r->elapsed = 0;
+      r->latched = FALSE;
+    } else if (r->holds(s)) {
+      if (!r->latched)
+        recordMargin(r, r->bound - r->elapsed);
+      r->latched = TRUE;
+    } else if (r->latched || r->elapsed >= r->bound) {
+      ok = FALSE;
+    } else {
+      r->elapsed++;
+    }
+    return ok;
+
+  case DWELL:
+    trigger = r->trigger(s);
+    if (trigger && !r->triggered) {
+      r->elapsed = 0;
+      r->latched = TRUE;
+    }
+    r->triggered = trigger;
+
+    if (r->latched) {
+      if (r->holds(s)) {
+        if (r->elapsed < NO_MARGIN - 1)
+          r->elapsed++;
+      } else {
+        r->latched = FALSE;
+        if (r->elapsed <= r->bound)
+          ok = FALSE;
+        else
+          recordMargin(r, r->elapsed - r->bound - 1);
+      }
     }
+    return ok;
+
+  case ON_ENTRY:
+    trigger = r->trigger(s);
+    if (!trigger && r->triggered)
+      r->latched = FALSE;
+    if (r->since != NULL && r->since(s))
+      r->latched = TRUE;
+    if (trigger && !r->triggered)
+      ok = r->latched || r->holds(s);
+    r->triggered = trigger;
+    return ok;
+
+  default:
+    assert(0);
+    return FALSE;
+  }
+}
+
+static void violated(Requirement *r, const Snapshot *s) {
+  setCarMotorStopped(1);
+
+  // journal the violation before anything slow happens
+  recordViolation(r - requirements, s->now, s->position, s->inputs,
+                  (s32)s->up - (s32)s->down);
+  flushJournal();
+
+  logMessage("SAFETY REQUIREMENT %s VIOLATED: STOPPING ELEVATOR\n",
+             (u32)r->name, 0, 0);
+  for (;;) {
+    setCarMotorStopped(1);
+    // keep checking in: the stop must not end in a reset
+    heartbeat(safetyHeartbeat);
+    vTaskDelayUntil(&xLastWakeTime, POLL_TIME);
+  }
+}
+
+// account the execution time of one cycle
+static void recordCycle(u32 cycles) {
+  static bool overBudget = FALSE;
+
+  if (cycles < timing.minCycles)
+    timing.minCycles = cycles;
+  if (cycles > timing.maxCycles)
+    timing.maxCycles = cycles;
+  timing.totalCycles += cycles;
+  timing.cycles++;
+
+  if (cycles > SAFETY_BUDGET_US * CYCLES_PER_US) {
+    timing.overBudget++;
+    if (!overBudget)
+      logMessage("SAFETY CYCLE OVER BUDGET: %lu us\n",
+                 cycles / CYCLES_PER_US, 0, 0);
+    overBudget = TRUE;
+  } else {
+    overBudget = FALSE;
   }
 }
 
 static void safetyTask(void *params) {
-  s16 timeSinceStopPressed = -1;
-  u16 timeSpeedMeasure = 0;
-  u32 timetowait = 0;
-  s32 currentPosition = 0;
-  s32 oldPosition = 0;
-	static bool floornew;
-	static bool old_MOTOR_STOPPED = TRUE;
-	static bool old_STOP_PRESSED = FALSE;
-	
+  Requirement *r;
+  Snapshot snapshot;
+  u32 cycleStart, start, cost;
+
+  // edges are only detected from the first cycle on, except that
+  // a dwell also starts if the car is already stopped at a floor
+  takeSnapshot(&snapshot);
+  for (r = requirements; r < requirements + REQUIREMENTS; ++r) {
+    if (r->trigger != NULL)
+      r->triggered = r->kind != DWELL && r->trigger(&snapshot);
+  }
 
   xLastWakeTime = xTaskGetTickCount();
 
   for (;;) {
-    // Environment assumption 1: the doors can only be opened if
-	//                           the elevator is at a floor and
-    //                           the motor is not active
-
-	check((AT_FLOOR && MOTOR_STOPPED) || DOORS_CLOSED,
-	      "env1");
+    cycleStart = DWT_CYCCNT;
+    takeSnapshot(&snapshot);
+
+    for (r = requirements; r < requirements + REQUIREMENTS; ++r) {
+      start = DWT_CYCCNT;
+      if (!evaluate(r, &snapshot))
+        violated(r, &snapshot);
+      cost = DWT_CYCCNT - start;
+      if (cost > r->maxCost)
+        r->maxCost = cost;
+    }
 
-	// Environment assumption 2: The elevator moves at a maximum speed of 50cm/s
-  //make the measurement every 60 ms ( max 3cm/60ms - keep the sampling point in the same place of the pulse)
+    // includes preemption by tasks of higher priority and interrupts
+    recordCycle(DWT_CYCCNT - cycleStart);
 
-  currentPosition = getCarPosition();
+    // the cycle has to be completed before the next one is due
+    if (xTaskGetTickCount() - xLastWakeTime >= POLL_TIME)
+      timing.deadlineMisses++;
 
-  //limit against overflow
-	if (timeSpeedMeasure <= CAR_SPEED_SAMPLING_INTERVAL) {
-		timeSpeedMeasure++;
-	}
+    heartbeat(safetyHeartbeat);
 
-  if(timeSpeedMeasure == CAR_SPEED_SAMPLING_INTERVAL)
-  { 
-    check( ABS(currentPosition - oldPosition) <= 4, "env2");
-    oldPosition = currentPosition;
-    timeSpeedMeasure = 0;
+	vTaskDelayUntil(&xLastWakeTime, POLL_TIME);
   }
-  
-
-	// Environment assumption 3
-  // If the ground floor is put at 0cm in an absolute coordinate system, 
-  // the second floor is at 400cm and 
-  // the third floor at 800cm (the at-floor sensor reports a floor with a threshold of +-0.5cm)
-  if(AT_FLOOR)
-  check (( currentPosition <= ( TRACKER_FLOOR1_POS + 1 )) ||  \
-        (( currentPosition >= ( TRACKER_FLOOR2_POS - 1 )) && ( currentPosition <= ( TRACKER_FLOOR2_POS + 1 ))) || \
-         ( currentPosition >= ( TRACKER_FLOOR3_POS - 1 )), "env3");
-
-	// Environment assumption 4: The values of the inputs stabilize on 0 or 1 within 20 ms 
-	check(checkInputsStabilized(), "env4");
-
-    // System requirement 1: if the stop button is pressed, the motor is
-	//                       stopped within 1s
-
-	if (STOP_PRESSED) {
-	  if (timeSinceStopPressed < 0)
-	    timeSinceStopPressed = 0;
-      else {
-				if (timeSinceStopPressed < CAR_STOP_PERIOD) {
-					timeSinceStopPressed++;
-				}
-    		check((timeSinceStopPressed <= CAR_STOP_PERIOD) || MOTOR_STOPPED,	"req1");
-			}
-	} else {
-	  timeSinceStopPressed = -1;
-	}
-
-    // System requirement 2: the motor signals for upwards and downwards
-	//                       movement are not active at the same time
-
-    check(!MOTOR_UPWARD || !MOTOR_DOWNWARD,
-          "req2");
-
-	// Safety requirement 3: The elevator may not pass the end positions, that is, go through the roof or the floor 
-	check((currentPosition >= TRACKER_FLOOR1_POS) && (currentPosition <= TRACKER_FLOOR3_POS), "req3");
-
-	old_STOP_PRESSED |= (bool) STOP_PRESSED;
-
-	// Safety requirement 4: A moving elevator halts only if the stop button is pressed or the elevator has arrived at a floor
-	check(old_MOTOR_STOPPED || (AT_FLOOR || old_STOP_PRESSED || !MOTOR_STOPPED), "req4");
-
-	old_MOTOR_STOPPED =	(bool) MOTOR_STOPPED;
-	
-
-	// Safety requirement 5: Once the elevator has stopped at a floor, it will wait for at least 1s before it continues to another floor
-	//check((( timetowait > FLOOR_TIMEOUT ) && !MOTOR_STOPPED) || MOTOR_STOPPED, "req5");
-  check(( timetowait > FLOOR_TIMEOUT ) || MOTOR_STOPPED, "req5");
-
-  if(MOTOR_STOPPED && AT_FLOOR){
-		if(floornew == TRUE){
-			timetowait = 0;
-			floornew = FALSE;
-		}
-		//limit against overflow
-    if (timetowait <= FLOOR_TIMEOUT + 1) {
-			timetowait++;
-		}
-	} else {
-    floornew = TRUE;
-	}
-
-  
-
-	// Safety requirement 6: The elevator will not move while the doors are open
-	// This requirement is covered by the implementation of  Environment assumption 1
-	check(1, "req6");
-
-	// Safety requirement 7: The maximum accelleration/decelleration of the elevator is 100 cm / s2
-	check(1, "req7");
-
-
-	// Safety requirement 8: The elevator moves only when it is called/ordered to go to a floor
-	check(MOTOR_STOPPED || (getPlannerTargetPosition() == getCarTargetPosition()), "req8");
 
-	vTaskDelayUntil(&xLastWakeTime, POLL_TIME);
+}
+
+const char *getRequirementName(u8 id) {
+  return id < REQUIREMENTS ? requirements[id].name : "unknown";
+}
+
+void getSafetyTiming(SafetyTiming *t) {
+  taskENTER_CRITICAL();
+  *t = timing;
+  taskEXIT_CRITICAL();
+}
+
+void printSafetyReport(void) {
+  Requirement *r;
+  SafetyTiming t;
+
+  getSafetyTiming(&t);
+  if (t.cycles > 0)
+    printf("safety cycle: min %lu us, mean %lu us, max %lu us, budget %u us, "
+           "%lu over budget, %lu deadlines missed\n",
+           t.minCycles / CYCLES_PER_US,
+           (u32)(t.totalCycles / t.cycles) / CYCLES_PER_US,
+           t.maxCycles / CYCLES_PER_US, SAFETY_BUDGET_US,
+           t.overBudget, t.deadlineMisses);
+
+  for (r = requirements; r < requirements + REQUIREMENTS; ++r) {
+    printf("%s: max %lu cycles", r->name, r->maxCost);
+    if (r->margin != NO_MARGIN)
+      printf(", margin %lu ms of %lu ms", r->margin * POLL_TIME * portTICK_RATE_MS,
+             r->bound * POLL_TIME * portTICK_RATE_MS);
+    printf("\n");
   }
+}
 
+static void safetyReportTask(void *params) {
+  portTickType lastReport;
+
+  lastReport = xTaskGetTickCount();
+
+  for (;;) {
+    vTaskDelayUntil(&lastReport, reportPeriod);
+    printSafetyReport();
+  }
 }
 
 void setupSafety(unsigned portBASE_TYPE uxPriority) {
-  xTaskCreate(safetyTask, "safety", 100, NULL, uxPriority, NULL);
+  Requirement *r;
+
+  for (r = requirements; r < requirements + REQUIREMENTS; ++r)
+    r->margin = NO_MARGIN;
+
+  // enable the cycle counter
+  DEMCR |= DEMCR_TRCENA;
+  DWT_CYCCNT = 0;
+  DWT_CTRL |= DWT_CYCCNTENA;
+
+  safetyHeartbeat = registerHeartbeat("safety", 100 / portTICK_RATE_MS);
+  xTaskCreateStatic(safetyTask, "safety", SAFETY_STACK_SIZE, NULL, uxPriority, NULL,
+                    safetyStack, &safetyTaskBuffer);
+}
+
+void setupSafetyReport(portTickType period,
+                       unsigned portBASE_TYPE uxPriority) {
+  portBASE_TYPE res;
+
+  reportPeriod = period;
+  res = xTaskCreateStatic(safetyReportTask, "safety report",
+                          SAFETY_REPORT_STACK_SIZE, NULL, uxPriority, NULL,
+                          reportStack, &reportTaskBuffer);
+  assert(res == pdTRUE);
 }
@@ -13,6 +13,47 @@
 #ifndef SAFETY_H
 #define SAFETY_H
 
+/**
+ * Execution time of the safety cycles, measured with the cycle
+ * counter (unit is CPU cycles)
+ */
+typedef struct {
+  u32 minCycles, maxCycles;
+  unsigned long long totalCycles;
+  u32 cycles;                 // number of cycles measured
+  u32 overBudget;             // cycles that exceeded the budget
+  u32 deadlineMisses;         // cycles not completed within the period
+} SafetyTiming;
+
+/**
+ * Create the task monitoring the requirements. They are given
+ * as a table of predicates and bounded-time monitors, which is
+ * evaluated every 10 ms
+ */
 void setupSafety(unsigned portBASE_TYPE uxPriority);
 
+/**
+ * Name of a requirement, given its id (as recorded in the
+ * journal)
+ */
+const char *getRequirementName(u8 id);
+
+/**
+ * Copy the execution time statistics of the safety task
+ */
+void getSafetyTiming(SafetyTiming *t);
+
+/**
+ * Print the execution time of the safety cycles, and the
+ * evaluation cost of each requirement and the
+ * smallest margin to its time bound observed so far
+ */
+void printSafetyReport(void);
+
+/**
+ * Create a task that periodically prints the report
+ */
+void setupSafetyReport(portTickType period,
+                       unsigned portBASE_TYPE uxPriority);
+
 #endif
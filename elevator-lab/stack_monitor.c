@@ -0,0 +1,90 @@
+/**
+ * Program skeleton for the course "Programming embedded systems"
+ *
+ * Lab 1: the elevator control system
+ */
+
+/**
+ * Stack monitoring: periodic report of how much of its stack each
+ * task has ever used and of the state of the heap, and the hook
+ * called by the kernel when a stack overflow is detected
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stm32f10x_usart.h"
+
+#include "stack_monitor.h"
+#include "logger.h"
+#include "assert.h"
+
+#define STACK_REPORT_STACK_SIZE 120
+
+static xTaskStackUsageType usage[STACK_MONITOR_MAX_TASKS];
+
+static portTickType reportPeriod;
+
+static xStaticTaskType reportTaskBuffer;
+static portSTACK_TYPE reportStack[STACK_REPORT_STACK_SIZE];
+
+// write to USART 1 by polling, bypassing the serial driver and
+// its queue
+static void writeDirectly(const char *s) {
+  while (*s) {
+    while (USART_GetFlagStatus(USART1, USART_FLAG_TXE) == RESET);
+    USART_SendData(USART1, *s++);
+  }
+}
+
+void vApplicationStackOverflowHook(xTaskHandle *pxTask,
+                                   signed char *pcTaskName) {
+  // the stack and the data next to it are corrupt, so the kernel
+  // cannot be trusted anymore (and the hook is called from the
+  // context switch, where no queue may be used). Stop everything
+  // and wait for the watchdog, which is no longer fed; the reset
+  // also switches off the motor
+  taskDISABLE_INTERRUPTS();
+  writeDirectly("STACK OVERFLOW: task ");
+  writeDirectly((const char*)pcTaskName);
+  writeDirectly("\n");
+  for (;;);
+}
+
+static void stackReportTask(void *params) {
+  portTickType xLastWakeTime;
+  unsigned portBASE_TYPE num, i;
+#if configSUPPORT_DYNAMIC_ALLOCATION == 1
+  xHeapStatsType heap;
+#endif
+
+  xLastWakeTime = xTaskGetTickCount();
+
+  for (;;) {
+    vTaskDelayUntil(&xLastWakeTime, reportPeriod);
+
+    num = uxTaskGetStackUsage(usage, STACK_MONITOR_MAX_TASKS);
+    for (i = 0; i < num; ++i)
+      logMessage("stack %s: %lu of %lu words unused\n",
+                 (u32)usage[i].pcTaskName,
+                 usage[i].usHighWaterMark, usage[i].usStackDepth);
+
+#if configSUPPORT_DYNAMIC_ALLOCATION == 1
+    vPortGetHeapStats(&heap);
+    logMessage("heap: %lu bytes free, largest block %lu, %lu%% fragmented\n",
+               heap.xFreeBytes, heap.xLargestFreeBlock, heap.uxFragmentation);
+    logMessage("heap: at least %lu bytes ever free\n", heap.xMinimumEverFreeBytes,
+               0, 0);
+#endif
+  }
+}
+
+void setupStackReport(portTickType period,
+                      unsigned portBASE_TYPE uxPriority) {
+  portBASE_TYPE res;
+
+  reportPeriod = period;
+  res = xTaskCreateStatic(stackReportTask, "stack report",
+                          STACK_REPORT_STACK_SIZE, NULL, uxPriority, NULL,
+                          reportStack, &reportTaskBuffer);
+  assert(res == pdTRUE);
+}
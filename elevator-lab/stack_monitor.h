@@ -0,0 +1,39 @@
+/**
+ * Program skeleton for the course "Programming embedded systems"
+ *
+ * Lab 1: the elevator control system
+ */
+
+/**
+ * Stack monitoring: periodic report of how much of its stack each
+ * task has ever used and of the state of the heap, and the hook
+ * called by the kernel when a stack overflow is detected
+ */
+
+#ifndef STACK_MONITOR_H
+#define STACK_MONITOR_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+// maximum number of tasks that are reported
+#define STACK_MONITOR_MAX_TASKS 16
+
+/**
+ * Called by the kernel at a context switch if the stack of the
+ * task that is switched out has overflowed. The system is halted,
+ * so that the watchdog resets it
+ */
+void vApplicationStackOverflowHook(xTaskHandle *pxTask,
+                                   signed char *pcTaskName);
+
+/**
+ * Create a task that logs the stack size and the high water mark
+ * (smallest number of unused words) of every task each "period"
+ * ticks. The log can be turned into recommended stack sizes with
+ * the host tool in stacksize/
+ */
+void setupStackReport(portTickType period,
+                      unsigned portBASE_TYPE uxPriority);
+
+#endif
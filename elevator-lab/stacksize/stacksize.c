@@ -0,0 +1,174 @@
+/**
+ * Program skeleton for the course "Programming embedded systems"
+ *
+ * Lab 1: the elevator control system
+ */
+
+/**
+ * Host tool turning the stack report of the target (stack_monitor.c)
+ * into recommended stack sizes.
+ *
+ * The serial output of the target is captured while the system is
+ * exercised (e.g., while running the test cases of the simulator), and
+ * fed into this tool. For every task, the largest stack usage seen in
+ * any report is taken, a safety margin is added, and the result is
+ * compared to the current stack size. Only paths that were executed
+ * during the capture are covered, so the margin should not be too
+ * small.
+ *
+ * Build and run on the host (from this directory):
+ *
+ *   gcc -O2 -o stacksize stacksize.c
+ *
+ *   ./stacksize [-m percent] [-w words] [capture.txt]
+ *
+ * -m is the margin in percent of the measured usage (default 25), -w
+ * the minimum margin in words (default 16). Without a file, the capture
+ * is read from stdin.
+ *
+ * Report lines have the format "stack <task>: <unused> of <size> words
+ * unused", optionally preceded by the log timestamp; other lines are
+ * ignored
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_TASKS     32
+#define MAX_NAME      32
+#define MAX_LINE      256
+
+typedef struct {
+  char name[MAX_NAME];
+  unsigned long size;        // stack size in words
+  unsigned long minUnused;   // smallest high water mark reported
+  unsigned long reports;
+} TaskStack;
+
+static TaskStack tasks[MAX_TASKS];
+static int numTasks = 0;
+
+static TaskStack *findTask(const char *name) {
+  int i;
+
+  for (i = 0; i < numTasks; ++i)
+    if (strcmp(tasks[i].name, name) == 0)
+      return tasks + i;
+
+  if (numTasks == MAX_TASKS) {
+    fprintf(stderr, "too many tasks, ignoring %s\n", name);
+    return NULL;
+  }
+
+  // the name has already been truncated to MAX_NAME - 1 characters
+  strcpy(tasks[numTasks].name, name);
+  tasks[numTasks].minUnused = (unsigned long)-1;
+  return tasks + numTasks++;
+}
+
+// parse one line of the capture; returns 0 if it is not a stack report
+static int parseLine(const char *line) {
+  const char *start, *colon;
+  char name[MAX_NAME];
+  unsigned long unused, size;
+  TaskStack *task;
+  size_t len;
+
+  if (strncmp(line, "stack ", 6) == 0)
+    start = line + 6;
+  else if ((start = strstr(line, "] stack ")) != NULL)
+    start += 8;
+  else
+    return 0;
+
+  // task names may contain blanks, so the name ends at the last colon
+  colon = strrchr(start, ':');
+  if (colon == NULL ||
+      sscanf(colon + 1, " %lu of %lu words unused", &unused, &size) != 2)
+    return 0;
+
+  len = colon - start;
+  if (len >= MAX_NAME)
+    len = MAX_NAME - 1;
+  memcpy(name, start, len);
+  name[len] = '\0';
+
+  task = findTask(name);
+  if (task == NULL)
+    return 0;
+
+  task->size = size;
+  if (unused < task->minUnused)
+    task->minUnused = unused;
+  task->reports++;
+  return 1;
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr, "usage: %s [-m percent] [-w words] [capture.txt]\n", prog);
+  exit(1);
+}
+
+int main(int argc, char **argv) {
+  unsigned long marginPercent = 25, marginWords = 16;
+  unsigned long used, margin, recommended;
+  long totalSaved = 0;
+  char line[MAX_LINE];
+  FILE *in = stdin;
+  int i, overflows = 0;
+
+  for (i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-m") == 0 && i + 1 < argc)
+      marginPercent = strtoul(argv[++i], NULL, 10);
+    else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+      marginWords = strtoul(argv[++i], NULL, 10);
+    else if (argv[i][0] == '-')
+      usage(argv[0]);
+    else if ((in = fopen(argv[i], "r")) == NULL) {
+      perror(argv[i]);
+      return 1;
+    }
+  }
+
+  while (fgets(line, sizeof(line), in) != NULL)
+    parseLine(line);
+
+  if (numTasks == 0) {
+    fprintf(stderr, "no stack reports found\n");
+    return 1;
+  }
+
+  printf("%-16s %8s %8s %8s %12s %8s\n",
+         "task", "reports", "size", "max used", "recommended", "saved");
+
+  for (i = 0; i < numTasks; ++i) {
+    TaskStack *t = tasks + i;
+
+    used = t->size - t->minUnused;
+    margin = used * marginPercent / 100;
+    if (margin < marginWords)
+      margin = marginWords;
+
+    // stacks are aligned to 8 bytes, i.e., an even number of words
+    recommended = (used + margin + 1) & ~1UL;
+
+    printf("%-16s %8lu %8lu %8lu %12lu %8ld%s\n",
+           t->name, t->reports, t->size, used, recommended,
+           (long)t->size - (long)recommended,
+           t->minUnused == 0 ? "  OVERFLOW?" : "");
+    totalSaved += (long)t->size - (long)recommended;
+    if (t->minUnused == 0)
+      overflows++;
+  }
+
+  printf("total: %ld words (%ld bytes) %s\n",
+         totalSaved < 0 ? -totalSaved : totalSaved,
+         4 * (totalSaved < 0 ? -totalSaved : totalSaved),
+         totalSaved < 0 ? "more needed" : "can be reclaimed");
+  if (overflows > 0)
+    printf("%d task(s) used the whole stack and may have overflowed; "
+           "their real usage is unknown\n", overflows);
+
+  return 0;
+}
@@ -38,9 +38,9 @@
 //#define _CAN
 
 /************************************* DMA ************************************/
-//#define _DMA
+#define _DMA
 //#define _DMA_Channel1
-//#define _DMA_Channel2
+#define _DMA_Channel2
 //#define _DMA_Channel3
 //#define _DMA_Channel4
 //#define _DMA_Channel5
@@ -65,17 +65,17 @@
 //#define _I2C2
 
 /************************************* IWDG ***********************************/
-//#define _IWDG
+#define _IWDG
 
 /************************************* NVIC ***********************************/
 #define _NVIC
 #define _SCB
 
 /************************************* BKP ************************************/
-//#define _BKP
+#define _BKP
 
 /************************************* PWR ************************************/
-//#define _PWR
+#define _PWR
 
 /************************************* RCC ************************************/
 #define _RCC
@@ -0,0 +1,133 @@
+/**
+ * Program skeleton for the course "Programming embedded systems"
+ *
+ * Lab 1: the elevator control system
+ */
+
+/**
+ * Supervisor feeding the independent watchdog
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stm32f10x_iwdg.h"
+#include "stm32f10x_bkp.h"
+#include "stm32f10x_pwr.h"
+#include "stm32f10x_rcc.h"
+#include <stdio.h>
+
+#include "watchdog.h"
+#include "logger.h"
+#include "assert.h"
+
+// the task that missed its deadline is kept in a backup
+// register, which survives the reset
+#define WATCHDOG_MISSED_REG  BKP_DR1
+
+// the LSI clock of the watchdog runs at about 40 kHz,
+// divided by 32 each count of the reload value is 0.8 ms
+#define LSI_KHZ              40
+#define WATCHDOG_PRESCALER   32
+
+#define SUPERVISOR_STACK_SIZE 80
+
+typedef struct {
+  const char *name;
+  portTickType deadline;
+  vu32 lastBeat;              // written by the task only
+} Heartbeat;
+
+static Heartbeat heartbeats[WATCHDOG_MAX_TASKS];
+static u8 numHeartbeats = 0;
+
+static u8 missedTask = WATCHDOG_NONE;
+static portTickType supervisionPeriod;
+
+static xStaticTaskType supervisorTaskBuffer;
+static portSTACK_TYPE supervisorStack[SUPERVISOR_STACK_SIZE];
+
+u8 registerHeartbeat(const char *name, portTickType deadline) {
+  assert(numHeartbeats < WATCHDOG_MAX_TASKS);
+
+  heartbeats[numHeartbeats].name = name;
+  heartbeats[numHeartbeats].deadline = deadline;
+  heartbeats[numHeartbeats].lastBeat = 0;
+
+  return numHeartbeats++;
+}
+
+void heartbeat(u8 id) {
+  heartbeats[id].lastBeat = xTaskGetTickCount();
+}
+
+u8 getWatchdogMissedTask(void) {
+  return missedTask;
+}
+
+static void supervisorTask(void *params) {
+  portTickType xLastWakeTime, now;
+  u8 i;
+
+  xLastWakeTime = xTaskGetTickCount();
+
+  for (;;) {
+    now = xTaskGetTickCount();
+
+    for (i = 0; i < numHeartbeats; ++i) {
+      if (now - heartbeats[i].lastBeat > heartbeats[i].deadline)
+        break;
+    }
+
+    if (i == numHeartbeats) {
+      IWDG_ReloadCounter();
+    } else if (missedTask == WATCHDOG_NONE) {
+      // stop feeding the watchdog; the system is reset when it
+      // expires
+      missedTask = i;
+      BKP_WriteBackupRegister(WATCHDOG_MISSED_REG, i + 1);
+      logMessage("WATCHDOG: task %s missed its deadline\n",
+                 (u32)heartbeats[i].name, 0, 0);
+    }
+
+    vTaskDelayUntil(&xLastWakeTime, supervisionPeriod);
+  }
+}
+
+void setupWatchdog(u16 timeout, portTickType period,
+                   unsigned portBASE_TYPE uxPriority) {
+  portBASE_TYPE res;
+  u16 reload = timeout * LSI_KHZ / WATCHDOG_PRESCALER;
+  u8 i;
+
+  assert(reload > 0 && reload <= 0xFFF);
+  supervisionPeriod = period;
+
+  RCC_APB1PeriphClockCmd( RCC_APB1Periph_PWR | RCC_APB1Periph_BKP, ENABLE );
+  PWR_BackupAccessCmd(ENABLE);
+
+  if (RCC_GetFlagStatus(RCC_FLAG_IWDGRST) != RESET) {
+    i = (u8)BKP_ReadBackupRegister(WATCHDOG_MISSED_REG);
+    if (i > 0 && i <= numHeartbeats)
+      printf("WATCHDOG RESET: task %s missed its deadline\n",
+             heartbeats[i - 1].name);
+    else
+      printf("WATCHDOG RESET\n");
+  }
+  RCC_ClearFlag();
+  BKP_WriteBackupRegister(WATCHDOG_MISSED_REG, 0);
+
+  // tasks that have not run yet are within their deadline
+  for (i = 0; i < numHeartbeats; ++i)
+    heartbeats[i].lastBeat = xTaskGetTickCount();
+
+  IWDG_WriteAccessCmd(IWDG_WriteAccess_Enable);
+  IWDG_SetPrescaler(IWDG_Prescaler_32);
+  IWDG_SetReload(reload);
+  IWDG_ReloadCounter();
+  IWDG_Enable();
+
+  res = xTaskCreateStatic(supervisorTask, "supervisor",
+                          SUPERVISOR_STACK_SIZE, NULL, uxPriority, NULL,
+                          supervisorStack, &supervisorTaskBuffer);
+  assert(res == pdTRUE);
+}
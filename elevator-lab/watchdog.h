@@ -0,0 +1,53 @@
+/**
+ * Program skeleton for the course "Programming embedded systems"
+ *
+ * Lab 1: the elevator control system
+ */
+
+/**
+ * Supervisor feeding the independent watchdog (IWDG) only as
+ * long as all critical tasks keep checking in. A task that hangs,
+ * e.g., blocked forever on a semaphore, thus resets the system
+ * within the watchdog timeout
+ */
+
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include "FreeRTOS.h"
+#include "stm32f10x_type.h"
+
+#define WATCHDOG_MAX_TASKS 8
+
+// no task has missed its deadline
+#define WATCHDOG_NONE      0xFF
+
+/**
+ * Register a task that has to call "heartbeat" at least once
+ * every "deadline" ticks. To be called before the scheduler is
+ * started; returns the id to be passed to "heartbeat"
+ */
+u8 registerHeartbeat(const char *name, portTickType deadline);
+
+/**
+ * Check in; to be called by the registered task only
+ */
+void heartbeat(u8 id);
+
+/**
+ * Start the watchdog (timeout "timeout" ms, at most 3276) and
+ * the supervisor task, which checks the heartbeats every
+ * "period" ticks. If the last reset was caused by the watchdog,
+ * the task that had missed its deadline is reported. To be
+ * called after all heartbeats have been registered
+ */
+void setupWatchdog(u16 timeout, portTickType period,
+                   unsigned portBASE_TYPE uxPriority);
+
+/**
+ * The task that has missed its deadline, so that the watchdog
+ * is no longer fed, or WATCHDOG_NONE
+ */
+u8 getWatchdogMissedTask(void);
+
+#endif